@@ -1,586 +1,5900 @@
+// Compilação: gcc -O2 -pthread "PROJETO PEM P2.c" -o hotel (com -DSEM_INSTRUMENTACAO, sem contadores de desempenho)
+#define _DEFAULT_SOURCE                 // Expõe mmap/madvise/fsync mesmo compilando com -std=c99
 #include <stdio.h>                      // Entrada/saída padrão (printf, scanf)
 #include <stdlib.h>                     // Alocação de memória, exit, realloc, free
 #include <string.h>                     // Operações com strings (strcpy, strcmp)
+#include <stdarg.h>                     // Argumentos variáveis (saida_printf do modo lote)
+#include <time.h>                       // clock_gettime/clock (medições do benchmark e da instrumentação)
+#include <limits.h>                     // LONG_MIN (máximo acumulado das agendas)
+
+#if defined(__unix__) || defined(__APPLE__)
+#define PLATAFORMA_POSIX 1              // mmap/fsync/sockets/pthreads disponíveis
+#include <sys/mman.h>                   // mmap/munmap (carga rápida do snapshot)
+#include <sys/stat.h>                   // fstat (tamanho do arquivo)
+#include <fcntl.h>                      // open
+#include <unistd.h>                     // close, sysconf
+#include <pthread.h>                    // Pool de threads das consultas paralelas e travas do servidor
+#include <signal.h>                     // sigaction (encerramento do servidor), SIGPIPE
+#include <errno.h>                      // EINTR
+#include <sys/socket.h>                 // Socket local do modo servidor
+#include <sys/un.h>                     // sockaddr_un
+#endif
 
 #define TAM_TIPO 20                     // Tamanho máximo do campo 'tipo' do quarto
 #define LIVRE 0                         // Constante para status LIVRE do quarto
 #define OCUPADO 1                       // Constante para status OCUPADO do quarto
 #define MANUTENCAO 2                    // Constante para status MANUTENCAO do quarto
 #define TAM_NOME 50                     // Tamanho máximo do campo 'nome' do hóspede
-#define TAM_CPF 15                      // Tamanho máximo do campo 'cpf' (string)
-#define TAM_TELEFONE 20                 // Tamanho máximo do campo 'telefone'
+#define TAM_CPF 15                      // Tamanho máximo do CPF digitado (aceita "000.000.000-00")
+#define TAM_TELEFONE 20                 // Tamanho máximo do telefone digitado
+#define DIGITOS_CPF 11                  // Dígitos do CPF (guardado como inteiro de 64 bits)
+#define MAX_DIGITOS_TELEFONE 18         // Dígitos do telefone que cabem no inteiro de 64 bits com o marcador
+#define IDS_POR_BLOCO_HISTORICO 7       // IDs de reserva em cada bloco do pool de históricos
+#define TAM_BLOCO_HISTORICO (IDS_POR_BLOCO_HISTORICO + 1) // Inteiros por bloco: os IDs e o próximo bloco (-1 = último)
 #define TAM_DATA 11                     // Tamanho para data "DD/MM/AAAA" + '\0' (10 + 1)
 #define ATIVA 0                         // Constante para reserva ATIVA
 #define CONCLUIDA 1                     // Constante para reserva CONCLUIDA
 #define CANCELADA 2                     // Constante para reserva CANCELADA
+#define OPERACAO_OK 0                   // Resultado das operações do núcleo: sucesso
+#define ERRO_QUARTO_EXISTENTE 1         // Número de quarto já cadastrado
+#define ERRO_QUARTO_INEXISTENTE 2       // Número de quarto não cadastrado
+#define ERRO_QUARTO_INDISPONIVEL 3      // Quarto ocupado ou em manutenção
+#define ERRO_HOSPEDE_EXISTENTE 4        // CPF já cadastrado
+#define ERRO_HOSPEDE_INEXISTENTE 5      // CPF não cadastrado
+#define ERRO_DATAS_INVALIDAS 6          // Data mal formada ou check-out não posterior ao check-in
+#define ERRO_RESERVA_INVALIDA 7         // ID de reserva inexistente ou reserva não ativa
+#define ERRO_PARAMETRO_INVALIDO 8       // Campo fora do formato/faixa esperada
+#define ERRO_ARQUIVO 9                  // Falha ao abrir/ler/gravar arquivo
+#define ERRO_SNAPSHOT_INVALIDO 10       // Snapshot corrompido, de outra versão ou carregado sobre dados existentes
+#define ERRO_REPETIR_EXCLUSIVO 11       // Interno do servidor: a operação precisa da trava estrutural exclusiva
+#define ERRO_CPF_INVALIDO 12            // CPF sem exatamente 11 dígitos (aceita '.' e '-' entre eles)
+#define ERRO_TELEFONE_INVALIDO 13       // Telefone sem dígitos, com dígitos demais ou com outros caracteres
+#define LIMITE_INDICE_DIRETO 1048576    // Números de quarto abaixo disso usam a tabela direta; os demais, o hash
+#define TAM_BUFFER_SAIDA (1 << 16)      // Bytes acumulados antes de cada escrita no modo lote
+#define TAM_BUFFER_ENTRADA (1 << 16)    // Bytes lidos por vez do fluxo de comandos (também o maior tamanho de linha)
+#define MAX_CAMPOS_COMANDO 8            // Máximo de campos em uma linha de comando do modo lote
+#define HORIZONTE_CALENDARIO 1024       // Noites cobertas pelos bitmaps de ocupação (~2,8 anos)
+#define DIAS_PASSADOS_CALENDARIO 30     // Noites anteriores a hoje mantidas no início da janela
+#define MAX_THREADS 64                  // Limite de threads do pool de consultas paralelas
+#define BLOCOS_POR_THREAD 4             // Blocos por thread: equilibra a carga entre as threads
+#define MIN_QUARTOS_POR_BLOCO 256       // Abaixo disso, avaliar quartos em paralelo não compensa
+#define MIN_PALAVRAS_POR_BLOCO 64       // Idem para palavras dos bitmaps (cada uma cobre 64 quartos)
+#define MIN_RESERVAS_POR_BLOCO 4096     // Idem para reservas na listagem de ativas
+#define ARQUIVO_SOCKET "hotel.sock"     // Socket local padrão do modo servidor
+#define ARQUIVO_SNAPSHOT "hotel.snap"   // Snapshot padrão, carregado ao iniciar e gravado ao sair
+#define VERSAO_SNAPSHOT 8               // Versão do formato binário do snapshot (8: verificação FNV-1a do arquivo)
+#define NUM_COLUNAS_RESERVA 7           // Colunas da tabela de reservas (ver TabelaReservas)
+#define ARQUIVO_JOURNAL "hotel.journal" // Log de alterações posteriores ao último snapshot
+#define TAM_BUFFER_JOURNAL (1 << 16)    // Bytes de registros acumulados antes de cada gravação do journal
+#define JOURNAL_GRUPO 128               // Registros pendentes que forçam uma confirmação (fsync) em grupo
+#define JOURNAL_QUARTO 1                // Tipos de registro do journal: cadastro de quarto
+#define JOURNAL_HOSPEDE 2               // Cadastro de hóspede
+#define JOURNAL_RESERVA 3               // Criação de reserva
+#define JOURNAL_STATUS_RESERVA 4        // Cancelamento/conclusão de reserva
+#define JOURNAL_TARIFA 5                // Cadastro de regra de tarifa
+#define JOURNAL_MANUTENCAO 6            // Bloqueio de manutenção de um quarto por período
+#define JOURNAL_FIM_MANUTENCAO 7        // Bloqueio de manutenção desfeito
+#define BLOQUEIO_MANUTENCAO -1          // id_reserva dos intervalos de manutenção na agenda do quarto
+#define TODOS_OS_DIAS 0x7F              // Máscara de dias da semana de uma regra de tarifa: domingo (bit 0) a sábado (bit 6)
+#define MAX_PERCENTUAL_TARIFA 1000      // Maior percentual da diária aceito em uma regra (10x)
+#define MEDIDA_BUSCAR_QUARTO 0          // Operações instrumentadas: busca de quarto por número
+#define MEDIDA_BUSCAR_HOSPEDE 1         // Busca de hóspede por CPF
+#define MEDIDA_CRIAR_RESERVA 2          // Criação de reserva
+#define MEDIDA_ALTERAR_RESERVA 3        // Cancelamento/conclusão de reserva
+#define MEDIDA_QUARTO_DISPONIVEL 4      // Disponibilidade de um quarto em um período
+#define MEDIDA_QUARTOS_DISPONIVEIS 5    // Lista de quartos livres em um período
+#define MEDIDA_SALVAR_SNAPSHOT 6        // Gravação do snapshot
+#define MEDIDA_CARREGAR_SNAPSHOT 7      // Carga do snapshot
+#define MEDIDA_MAIS_BARATOS 8           // Quartos livres mais baratos de um tipo
+#define MEDIDA_BUSCAR_NOME 9            // Busca de hóspedes por nome (prefixo e aproximada)
+#define MEDIDA_ALOCAR_GRUPO 10          // Alocação de um grupo de reservas
+#define NUM_MEDIDAS 11                  // Quantidade de operações instrumentadas
+#define NUM_FAIXAS_LATENCIA 40          // Faixas do histograma: faixa k = latências em [2^(k-1), 2^k) ns
+#define NUM_SIMBOLOS_NOME 37            // Alfabeto dos nomes normalizados: espaço, a-z e 0-9
+#define NUM_TRIGRAMAS (NUM_SIMBOLOS_NOME * NUM_SIMBOLOS_NOME * NUM_SIMBOLOS_NOME) // Listas do índice de trigramas
+#define MAX_DISTANCIA_NOME 2            // Maior distância de edição aceita na busca aproximada de nomes
+#define MAX_RESULTADOS_NOME 100         // Máximo de hóspedes devolvidos por uma busca de nome
+#define TABELA_QUARTOS 0                // Tabelas da importação/exportação CSV: quartos
+#define TABELA_HOSPEDES 1               // Hóspedes
+#define TABELA_RESERVAS 2               // Reservas (ativas e arquivadas)
+#define NUM_TABELAS_CSV 3               // Quantidade de tabelas exportáveis
+#define MAX_CAMPOS_CSV 8                // Máximo de campos em uma linha de CSV importada
+#define TAM_JANELA_IMPORTACAO (1 << 24) // Bytes do CSV convertidos por vez na importação (memória limitada)
+#define MIN_BYTES_POR_BLOCO (1 << 16)   // Abaixo disso, converter linhas do CSV em paralelo não compensa
+#define MAX_REJEICOES_EXIBIDAS 20       // Linhas rejeitadas listadas por importação (as demais só contam)
+#define MAX_HOTEIS 32                   // Hotéis da rede (shards); também o multiplicador das entradas do histórico
+#define FOLGA_ABERTA_GRUPO 366          // Folga (noites) de um lado sem reserva vizinha na alocação de grupo
+
+#ifdef PLATAFORMA_POSIX
+typedef pthread_mutex_t Trava;          // Trava de exclusão mútua (modo servidor)
+#define TRAVA_INICIAL PTHREAD_MUTEX_INITIALIZER
+#define POR_THREAD __thread             // Variável com uma cópia por thread (hotel_atual)
+#else
+typedef int Trava;                      // Sem pthreads não há concorrência: travas vazias
+#define TRAVA_INICIAL 0
+#define POR_THREAD                      // Uma thread só: variável global comum
+#endif
 
 typedef struct {                        // Estrutura que representa um quarto
     int numero;                          // Número do quarto
     char tipo[TAM_TIPO];                 // Tipo do quarto (ex: "Standard")
     float preco_diaria;                  // Preço da diária
-    int status;                          // Status atual (LIVRE/OCUPADO/MANUTENCAO)
+    int status;                          // Status do cadastro: LIVRE = em operação (por data: status_quarto_em)
 } Quarto;
 
-typedef struct {                        // Estrutura que representa um hóspede
+typedef struct {                        // Estrutura que representa um hóspede (40 bytes, sem alocação própria)
+    unsigned long long cpf;              // CPF como inteiro (11 dígitos; texto_cpf formata)
+    unsigned long long telefone;         // 10^dígitos + número: guarda os zeros à esquerda (texto_telefone formata)
     int id_hospede;                      // Identificador único do hóspede
-    char nome[TAM_NOME];                 // Nome do hóspede
-    char cpf[TAM_CPF];                   // CPF do hóspede (string)
-    char telefone[TAM_TELEFONE];         // Telefone do hóspede
-    int *historico_ids_reservas;         // Vetor dinâmico de IDs de reservas no histórico
+    int nome;                            // Posição do nome na arena_nomes (nome_hospede devolve o texto)
+    int primeiro_bloco_historico;        // Blocos do histórico no pool_historicos (-1 = histórico vazio)
+    int ultimo_bloco_historico;          // Bloco que recebe o próximo ID
     int num_reservas_historico;          // Quantidade de IDs armazenados no histórico
 } Hospede;
 
-typedef struct {                        // Estrutura que representa uma reserva
+typedef struct {                        // Uma reserva inteira (linha montada a partir das colunas da tabela)
     int id_reserva;                      // ID único da reserva
     int numero_quarto;                   // Número do quarto reservado
     int id_hospede;                      // ID do hóspede que fez a reserva
-    char data_checkin[TAM_DATA];         // Data de check-in (DD/MM/AAAA)
-    char data_checkout[TAM_DATA];        // Data de check-out (DD/MM/AAAA)
+    long dia_checkin;                    // Check-in em dias absolutos (convertido uma vez, na criação)
+    long dia_checkout;                   // Check-out em dias absolutos
     int status_reserva;                  // Status da reserva (ATIVA/CONCLUIDA/CANCELADA)
-    float valor_total;                   // Valor total da reserva
+    long long valor_centavos;            // Valor total da reserva, em centavos exatos
 } Reserva;
 
-Quarto *quartos_hotel = NULL;           // Ponteiro para o array dinâmico de quartos (inicialmente vazio)
-int contador_quartos = 0;               // Contador do número de quartos cadastrados
+typedef struct {                        // Tabela de reservas em colunas: cada laço percorre só os campos que usa
+    int *id_reserva;                     // Coluna i = campo da reserva de índice i
+    int *numero_quarto;
+    int *id_hospede;
+    long *dia_checkin;
+    long *dia_checkout;
+    unsigned char *status_reserva;       // ATIVA/CONCLUIDA/CANCELADA em um byte: filtro de status lê pouca memória
+    long long *valor_centavos;
+} TabelaReservas;
+
+typedef struct {                        // Descrição genérica de uma coluna (crescimento e snapshot)
+    void *dados;                         // Início da coluna
+    size_t tamanho_elemento;             // Bytes por reserva
+} ColunaReserva;
+
+typedef struct {                        // Intervalo ocupado de um quarto: [checkin, checkout) em dias absolutos
+    long checkin;                        // Dia absoluto do check-in
+    long checkout;                       // Dia absoluto do check-out (exclusivo)
+    long max_checkout;                   // Maior checkout entre este intervalo e todos os anteriores
+    int id_reserva;                      // Reserva dona do intervalo
+} IntervaloReserva;
+
+typedef struct {                        // Agenda de um quarto: intervalos ordenados por checkin
+    IntervaloReserva *intervalos;        // Vetor dinâmico ordenado pelo dia de check-in
+    int num_intervalos;                  // Quantidade de intervalos na agenda
+    int capacidade;                      // Posições alocadas em 'intervalos'
+} AgendaQuarto;
+
+typedef struct {                        // Contadores de um tipo de quarto por período (noite ou mês)
+    long primeiro;                       // Período da posição 0 (dia absoluto, ou ano * 12 + mês - 1)
+    int quantidade;                      // Períodos cobertos a partir de 'primeiro'
+    int *noites;                         // Noites vendidas em cada período
+    long long *receita;                  // Receita dessas noites, em centavos exatos
+} SerieAnalise;
+
+typedef struct {                        // Quartos de um tipo em ordem de preço (índice secundário)
+    int *indices;                        // Índices em quartos_hotel, por (diária em centavos, número)
+    int quantidade;                      // Quartos do tipo
+    int capacidade;                      // Posições alocadas em 'indices'
+    int ordenado;                        // 0 = houve cadastro fora de ordem desde a última ordenação
+} IndicePrecoTipo;
+
+typedef struct {                        // Lista crescente de inteiros do índice de nomes
+    int *itens;                          // IDs (de hóspede ou de palavra) em ordem crescente
+    int quantidade;                      // Itens na lista
+    int capacidade;                      // Posições alocadas em 'itens'
+} ListaInteiros;
+
+typedef struct {                        // Um hóspede encontrado pela busca de nome
+    int indice_hospede;                  // Índice em hospedes_hotel
+    int distancia;                       // Soma das edições nas palavras da consulta (0 = casou exato)
+} ResultadoNome;
+
+typedef struct {                        // Regra de tarifa: percentual da diária nas noites que ela cobre
+    char tipo[TAM_TIPO];                 // Tipo de quarto afetado ("*" = todos)
+    long inicio;                         // Primeira noite coberta (dia absoluto)
+    long fim;                            // Noite seguinte à última coberta
+    int dias_semana;                     // Bits dos dias da semana em que a noite começa (TODOS_OS_DIAS = todos)
+    int percentual;                      // Diária da noite = preço da diária * percentual / 100
+} RegraTarifa;
+
+typedef struct {                        // Contadores de uma operação instrumentada (atualizados sem trava)
+    unsigned long long chamadas;         // Todas as chamadas
+    unsigned long long elementos;        // Elementos examinados (sondagens, noites, quartos, registros)
+    unsigned long long amostras;         // Chamadas cronometradas
+    unsigned long long soma_ns;          // Tempo somado das amostras
+    unsigned long long maximo_ns;        // Maior amostra
+    unsigned long long faixas[NUM_FAIXAS_LATENCIA]; // Histograma das amostras em faixas de potência de 2
+} Medida;
+
+typedef struct {                        // Uma oferta da cotação em lote
+    int indice_quarto;                   // Quarto livre no período
+    long long total_centavos;            // Valor exato da estadia nesse quarto
+} Oferta;
+
+typedef struct {                        // Hóspede como gravado no snapshot (sem o ponteiro do histórico)
+    int id_hospede;
+    char nome[TAM_NOME];
+    char cpf[TAM_CPF];
+    char telefone[TAM_TELEFONE];
+} HospedeArquivo;
+
+typedef struct {                        // Linha de reservas do CSV já convertida
+    char cpf[TAM_CPF];                   // Hóspede
+    int numero_quarto;
+    int status_reserva;                  // ATIVA, ou o status em que a reserva já terminou
+    long dia_checkin;
+    long dia_checkout;
+} ReservaImportada;
+
+typedef struct {                        // Uma linha do CSV importado, convertida por um bloco paralelo
+    int linha;                           // Linha dentro do bloco (numeração das rejeições)
+    int codigo;                          // OPERACAO_OK ou o erro de conversão
+    union {                              // Registro conforme a tabela importada
+        Quarto quarto;
+        HospedeArquivo hospede;
+        ReservaImportada reserva;
+    } dados;
+} LinhaImportada;
+
+typedef struct {                        // Linhas convertidas por um bloco da importação
+    LinhaImportada *linhas;              // Linhas não vazias, na ordem do arquivo
+    int quantidade;                      // Linhas convertidas
+    int capacidade;                      // Posições alocadas em 'linhas'
+    int linhas_lidas;                    // Linhas do bloco, inclusive as vazias
+} BlocoImportacao;
+
+typedef struct {                        // Cabeçalho do snapshot binário; seções alinhadas em 8 bytes
+    char magica[8];                      // "HOTELSNP"
+    int versao;                          // VERSAO_SNAPSHOT
+    int tamanho_quarto;                  // sizeof dos registros: detecta layout de outra compilação
+    int tamanho_hospede;
+    int tamanho_dia;                     // sizeof(long) das colunas de check-in/check-out
+    int tamanho_regra;                   // sizeof(RegraTarifa)
+    int num_hoteis;                      // Hotéis da rede (um SecaoHotelSnapshot para cada)
+    int num_hospedes;                    // Quantidade de registros em cada seção da rede
+    int num_ids_historico;               // Total de entradas de todos os históricos
+    long long inicio_hospedes;           // Deslocamento (bytes) de cada seção no arquivo
+    long long inicio_offsets_historico;  // num_hospedes + 1 ints: histórico do hóspede i = ids[off[i]..off[i+1])
+    long long inicio_ids_historico;
+    long long inicio_hoteis;             // num_hoteis registros SecaoHotelSnapshot
+    long long tamanho_total;             // Tamanho esperado do arquivo
+    long long ultimo_lsn;                // Último registro do journal já refletido no snapshot
+    unsigned long long verificacao;      // FNV-1a (64 bits) das seções após o cabeçalho e do cabeçalho com este campo zerado
+} CabecalhoSnapshot;
+
+typedef struct {                        // Seções de um hotel no snapshot
+    int num_quartos;                     // Quantidade de registros em cada seção
+    int num_reservas;                    // Reservas ativas
+    int num_arquivadas;                  // Reservas concluídas/canceladas
+    int num_regras;                      // Regras de tarifa, na ordem de cadastro
+    long long inicio_quartos;            // Deslocamento (bytes) de cada seção no arquivo
+    long long inicio_regras;
+    long long inicio_colunas_reservas[NUM_COLUNAS_RESERVA]; // Uma seção por coluna, na ordem de colunas_reservas
+    long long inicio_colunas_arquivadas[NUM_COLUNAS_RESERVA]; // Idem para o arquivo
+    int num_bloqueios;                   // Bloqueios de manutenção (BloqueioManutencao) do hotel
+    long long inicio_bloqueios;
+} SecaoHotelSnapshot;
+
+typedef struct {                        // Cabeçalho de cada registro do journal (seguido do conteúdo)
+    unsigned int tamanho;                // Bytes do conteúdo
+    unsigned int verificacao;            // FNV-1a do cabeçalho (com este campo zerado) + conteúdo
+    long long lsn;                       // Número de sequência do registro
+    int tipo;                            // JOURNAL_QUARTO, JOURNAL_HOSPEDE, ...
+    int hotel;                           // Hotel da alteração (índice em hoteis); mantém o cabeçalho com 24 bytes
+} CabecalhoJournal;
+
+typedef struct {                        // Conteúdo de JOURNAL_RESERVA
+    char cpf[TAM_CPF];                   // Hóspede (pelo CPF, estável entre execuções)
+    int numero_quarto;
+    int id_reserva;                      // ID gerado; a reaplicação confere se obtém o mesmo
+    long dia_checkin;
+    long dia_checkout;
+} RegistroJournalReserva;
+
+typedef struct {                        // Conteúdo de JOURNAL_STATUS_RESERVA
+    int id_reserva;
+    int novo_status;
+} RegistroJournalStatus;
+
+typedef struct {                        // Bloqueio de manutenção: seção do snapshot e conteúdo de JOURNAL_(FIM_)MANUTENCAO
+    int numero_quarto;
+    long inicio;                         // Primeira noite bloqueada (dia absoluto)
+    long fim;                            // Noite seguinte à última bloqueada
+} BloqueioManutencao;
+
+typedef struct {                        // Saída com buffer grande: evita um printf/syscall por linha
+    FILE *arquivo;                       // Destino final dos bytes
+    size_t usado;                        // Bytes ocupados em 'dados'
+    char dados[TAM_BUFFER_SAIDA];        // Área de acúmulo
+} BufferSaida;
+
+typedef struct {                        // Texto produzido por um bloco de uma tarefa paralela
+    char *dados;                         // Conteúdo (não terminado em '\0')
+    int usado;                           // Bytes ocupados
+    int capacidade;                      // Bytes alocados
+} TextoBloco;
+
+typedef void (*TarefaParalela)(int inicio, int fim, int bloco, void *contexto); // Processa [inicio, fim) como bloco 'bloco'
+
+typedef struct {                        // Leitor de linhas por blocos (substitui o scanf no modo lote)
+    FILE *arquivo;                       // Origem dos comandos
+    size_t inicio;                       // Primeiro byte ainda não consumido em 'dados'
+    size_t fim;                          // Fim dos bytes válidos em 'dados'
+    int fim_arquivo;                     // 1 quando a origem não tem mais dados
+    int descritor;                       // >= 0: lê com read() (socket: entrega o que chegou); -1: usa 'arquivo'
+    int linha_longa;                     // 1 quando a última linha passou de TAM_BUFFER_ENTRADA e foi descartada
+    char dados[TAM_BUFFER_ENTRADA + 1];  // Bloco lido (+1 para o '\0' da última linha)
+} LeitorLinhas;
+
+typedef struct {                        // Versão imutável das reservas de um hotel (ver VISTA VERSIONADA DAS RESERVAS)
+    unsigned long versao;                // versao_reservas do hotel quando a cópia foi feita
+    int referencias;                     // Leitores usando a vista, +1 enquanto ela é a vista atual do hotel
+    TabelaReservas ativas;               // Cópia das colunas do conjunto ativo
+    int num_ativas;                      // Reservas copiadas em 'ativas'
+    int capacidade_ativas;               // Posições alocadas em cada coluna de 'ativas'
+    int num_arquivadas;                  // Linhas do arquivo na versão (as primeiras não mudam mais)
+} VistaReservas;
+
+typedef struct {                        // Um hotel da rede: quartos, reservas, tarifas e tudo o que deriva deles
+    Quarto *quartos_hotel;               // Array dinâmico de quartos (inicialmente vazio)
+    int contador_quartos;                // Contador do número de quartos cadastrados
+    int capacidade_quartos;              // Posições alocadas em quartos_hotel (e em agendas_quartos)
+    AgendaQuarto *agendas_quartos;       // Agenda de cada quarto (mesmo índice de quartos_hotel)
+    Trava *travas_quartos;               // Trava de cada quarto no modo servidor (mesmo índice de quartos_hotel)
+    int *tipos_dos_quartos;              // ID do tipo de cada quarto no dicionário de tipos (mesmo índice de quartos_hotel)
+    int *indice_quartos_direto;          // Endereçamento direto: número do quarto -> índice em quartos_hotel; -1 = vazio
+    int tamanho_indice_direto;           // Números cobertos pela tabela direta: [0, tamanho_indice_direto)
+    int *indice_quartos_hash;            // Fallback hash (sondagem linear) para números fora da tabela direta
+    int capacidade_indice_quartos_hash;  // Posições da tabela hash (potência de 2)
+    int ocupacao_indice_quartos_hash;    // Quartos guardados na tabela hash
+    TabelaReservas reservas_hotel;       // Conjunto ativo: só reservas ATIVA, sem ordem
+    int contador_reservas;               // Reservas ativas
+    int capacidade_reservas;             // Posições alocadas em cada coluna de reservas_hotel
+    TabelaReservas reservas_arquivadas;  // Concluídas/canceladas, só acréscimo, em ordem de término
+    int contador_arquivadas;             // Reservas no arquivo
+    int capacidade_arquivadas;           // Posições alocadas em cada coluna do arquivo
+    int *indice_reservas_id;             // ID da reserva -> posição: >= 0 no conjunto ativo, -2-p no arquivo, -1 = vazio
+    int capacidade_indice_reservas_id;   // IDs cobertos: [0, capacidade)
+    unsigned long versao_reservas;       // Avança a cada criação/cancelamento/conclusão (sob trava_reservas)
+    VistaReservas *vista_reservas;       // Cópia da versão mais recente já lida; NULL até a primeira leitura
+    unsigned long long *calendario_ocupacao; // HORIZONTE_CALENDARIO linhas de 'palavras_por_noite' palavras
+    int palavras_por_noite;              // Palavras de 64 bits por linha (cobre palavras_por_noite * 64 quartos)
+    long calendario_inicio;              // Dia absoluto da primeira noite da janela
+    int calendario_valido;               // 0 = precisa ser refeito a partir das agendas antes da próxima consulta
+    unsigned long long *calendario_acumulado; // Área de trabalho da consulta (uma linha)
+    unsigned char *marcas_livres;        // Área de trabalho da consulta fora da janela: 1 se o quarto i está livre
+    int capacidade_marcas_livres;        // Posições alocadas em marcas_livres
+    char (*tipos_quarto)[TAM_TIPO];      // Dicionário de tipos: nome de cada ID de tipo, em ordem de cadastro
+    int contador_tipos;                  // Tipos distintos cadastrados
+    int capacidade_tipos;                // Posições alocadas em tipos_quarto (e nos vetores abaixo)
+    int *quartos_por_tipo;               // Quartos de cada tipo (oferta de noites, inclusive em manutenção)
+    SerieAnalise *series_diarias;        // Série por noite de cada tipo
+    SerieAnalise *series_mensais;        // Série por mês de cada tipo
+    RegraTarifa *regras_tarifa;          // Regras na ordem de cadastro (a mais recente prevalece)
+    int contador_regras;                 // Regras cadastradas
+    int capacidade_regras;               // Posições alocadas em regras_tarifa
+    IndicePrecoTipo *indices_preco;      // Índice de cada ID de tipo (mesmo índice de tipos_quarto)
+    int capacidade_indices_preco;        // Posições alocadas em indices_preco
+} Hotel;
+
+Hotel hoteis[MAX_HOTEIS];               // Hotéis da rede (zerados = vazios); os IDs de reserva são por hotel
+int num_hoteis = 1;                     // Hotéis em uso: [0, num_hoteis); cresce com HOTEL <n>
+POR_THREAD Hotel *hotel_atual = &hoteis[0]; // Hotel sobre o qual esta thread opera (ver REDE DE HOTEIS)
 
 Hospede * hospedes_hotel = NULL;        // Ponteiro para o array dinâmico de hóspedes
 int contador_hospedes = 0;              // Contador do número de hóspedes cadastrados
+int capacidade_hospedes = 0;            // Posições alocadas em hospedes_hotel
+char *arena_nomes = NULL;               // Nomes dos hóspedes, um após o outro, cada um terminado em '\0'
+int tamanho_arena_nomes = 0;            // Bytes usados em arena_nomes
+int capacidade_arena_nomes = 0;         // Bytes alocados em arena_nomes
+int *pool_historicos = NULL;            // Históricos de todos os hóspedes em blocos encadeados de TAM_BLOCO_HISTORICO
+int tamanho_pool_historicos = 0;        // Inteiros usados em pool_historicos
+int capacidade_pool_historicos = 0;     // Inteiros alocados em pool_historicos
+int *indice_cpf = NULL;                 // Tabela hash (endereçamento aberto) CPF -> índice em hospedes_hotel; -1 = vazio
+int capacidade_indice_cpf = 0;          // Número de posições da tabela (sempre potência de 2)
+int *indice_hospedes_id = NULL;         // ID do hóspede -> índice em hospedes_hotel; -1 = vazio (IDs são densos)
+int capacidade_indice_hospedes_id = 0;  // IDs cobertos: [0, capacidade)
 
-Reserva *reservas_hotel = NULL;         // Ponteiro para o array dinâmico de reservas
-int contador_reservas = 0;              // Contador do número de reservas cadastradas
 
 
 //CALCULOS PARA DIARIA
 int eh_bissexto(int ano);               // Protótipo: verifica se ano é bissexto
 long contar_dias(int dia, int mes, int ano); // Protótipo: converte data em dias absolutos
-int calcular_diferenca_dias(const char* data1_str, const char* data2_str); // Protótipo
+void dias_para_data(long n_dias, int *dia, int *mes, int *ano); // Protótipo: inverso de contar_dias
+long converter_data_em_dias(const char* data); // Protótipo: "DD/MM/AAAA" -> dias absolutos
+void formatar_data(long n_dias, char *saida); // Protótipo: dias absolutos -> "DD/MM/AAAA"
+int conflito_datas(long in1, long out1, long in2, long out2); // Protótipo: sobreposição de intervalos
+int ler_inteiro(const char *texto, int *valor); // Protótipo: texto decimal -> int (modo lote e importação CSV)
+int ler_preco(const char *texto, float *valor); // Protótipo: texto -> float
+const char *descrever_erro(int codigo); // Protótipo: texto de um código de resultado do núcleo
+char *ler_linha(LeitorLinhas *leitor); // Protótipo: próxima linha do fluxo (modo lote e alocação de grupo)
+void liberar_tabelas();                 // Protótipo: esvazia a rede (hotéis e hóspedes) após uma carga que falhou
+
+#define DATA_INVALIDA (-2147483647L)    // Retorno de converter_data_em_dias para data mal formada
 
 int eh_bissexto(int ano) {              // Implementação: verifica ano bissexto
     return (ano % 4 == 0 && ano % 100 != 0) || (ano % 400 == 0); // Regra do calendário gregoriano
 }
 
-long contar_dias(int dia, int mes, int ano) { // Converte uma data em um número total de dias
-    int dias_por_mes[] = {0, 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31}; // Dias por mês (índice 1..12)
-    long n_dias = 0;                   // Acumulador de dias
+long contar_dias(int dia, int mes, int ano) { // Converte uma data em dias absolutos (0 = 01/01/1970), em tempo constante
+    long a = (mes <= 2) ? ano - 1 : ano; // Ano começando em março: fevereiro (e o dia bissexto) fica no fim
+    long era = (a >= 0 ? a : a - 399) / 400; // Ciclo de 400 anos (146097 dias) que contém o ano
+    long ano_da_era = a - era * 400;     // [0, 399]
+    long dia_do_ano = (153 * (mes + (mes > 2 ? -3 : 9)) + 2) / 5 + dia - 1; // [0, 365], contado a partir de 1º de março
+    long dia_da_era = ano_da_era * 365 + ano_da_era / 4 - ano_da_era / 100 + dia_do_ano; // [0, 146096]
+    return era * 146097 + dia_da_era - 719468; // 719468 = dias de 01/03/0000 até 01/01/1970
+}
 
-    for (int i = 0; i < ano; i++) {    // Soma dias dos anos completos anteriores
-        n_dias += 365;                 // 365 dias por ano comum
-        if (eh_bissexto(i)) {          // Se ano anterior foi bissexto, soma 1 dia
-            n_dias++;
+void dias_para_data(long n_dias, int *dia, int *mes, int *ano) { // Inverso de contar_dias, também em tempo constante
+    long z = n_dias + 719468;            // Desloca a origem para 01/03/0000
+    long era = (z >= 0 ? z : z - 146096) / 146097;
+    long dia_da_era = z - era * 146097;  // [0, 146096]
+    long ano_da_era = (dia_da_era - dia_da_era / 1460 + dia_da_era / 36524 - dia_da_era / 146096) / 365; // [0, 399]
+    long dia_do_ano = dia_da_era - (365 * ano_da_era + ano_da_era / 4 - ano_da_era / 100); // [0, 365]
+    long mp = (5 * dia_do_ano + 2) / 153; // Mês começando em março [0, 11]
+    *dia = (int)(dia_do_ano - (153 * mp + 2) / 5 + 1);
+    *mes = (int)(mp < 10 ? mp + 3 : mp - 9);
+    *ano = (int)(ano_da_era + era * 400 + (*mes <= 2));
+}
+
+long converter_data_em_dias(const char* data) { // Lê "DD/MM/AAAA" e devolve dias absolutos (ou DATA_INVALIDA)
+    int partes[3] = {0, 0, 0};           // dia, mes, ano
+    int p = 0;                           // Parte sendo lida
+    int digitos = 0;                     // Dígitos lidos na parte atual
+    for (const char *c = data; ; c++) {  // Varre a string uma única vez
+        if (*c >= '0' && *c <= '9') {
+            partes[p] = partes[p] * 10 + (*c - '0');
+            if (++digitos > 4) return DATA_INVALIDA; // Nenhuma parte tem mais de 4 dígitos
+        } else if ((*c == '/' && p < 2) || (*c == '\0' && p == 2)) {
+            if (digitos == 0) return DATA_INVALIDA; // Parte vazia
+            if (*c == '\0') break;
+            p++;
+            digitos = 0;
+        } else {
+            return DATA_INVALIDA;        // Caractere inesperado
         }
     }
+    int dias_por_mes[] = {0, 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31}; // Dias por mês (índice 1..12)
+    int dia = partes[0], mes = partes[1], ano = partes[2];
+    if (mes < 1 || mes > 12 || dia < 1) return DATA_INVALIDA;
+    if (dia > dias_por_mes[mes] + (mes == 2 && eh_bissexto(ano))) return DATA_INVALIDA; // 29/02 só em ano bissexto
+    return contar_dias(dia, mes, ano);
+}
+
+void formatar_data(long n_dias, char *saida) { // Escreve "DD/MM/AAAA" em 'saida' (TAM_DATA bytes)
+    int dia, mes, ano;
+    dias_para_data(n_dias, &dia, &mes, &ano);
+    snprintf(saida, TAM_DATA, "%02d/%02d/%04d", dia, mes, ano);
+}
+
+int conflito_datas(long in1, long out1, long in2, long out2)
+{                                         // Verifica se dois intervalos [in1,out1) e [in2,out2) se sobrepõem
+    return (in1 < out2 && out1 > in2);    // Retorna true se houver sobreposição
+}
 
-    for (int i = 1; i < mes; i++) {    // Soma dias dos meses completos do ano atual
-        n_dias += dias_por_mes[i];
+//ARMAZENAMENTO DINAMICO COM CRESCIMENTO GEOMETRICO
+void *crescer_vetor(void *vetor, int *capacidade, int minimo, size_t tamanho_elemento, const char *descricao) {
+    // Garante espaço para pelo menos 'minimo' elementos, dobrando a capacidade (custo amortizado O(1) por inserção)
+    if (minimo <= *capacidade) {          // Já cabe: nada a fazer
+        return vetor;
     }
-    if (mes > 2 && eh_bissexto(ano)) { // Se já passou fevereiro e o ano atual é bissexto, soma 1
-        n_dias++;
+    int nova_capacidade = (*capacidade < 8) ? 8 : *capacidade; // Capacidade mínima de 8 elementos
+    while (nova_capacidade < minimo) {
+        nova_capacidade *= 2;             // Crescimento geométrico
     }
+    void *temp = realloc(vetor, (size_t)nova_capacidade * tamanho_elemento);
+    if (temp == NULL) {                   // Verifica se a realocação falhou
+        fprintf(stderr, "Erro fatal: Nao foi possivel alocar memoria para %s!\n", descricao);
+        free(vetor);                      // Libera memória anterior, se houver
+        exit(1);                          // Encerra o programa devido ao erro crítico
+    }
+    *capacidade = nova_capacidade;
+    return temp;
+}
 
-    n_dias += dia;                     // Soma os dias do mês corrente
-    return n_dias;                     // Retorna total de dias
+void *anexar_registros(void *vetor, int *quantidade, int *capacidade, const void *registros, int n,
+                       size_t tamanho_elemento, const char *descricao) { // Anexa 'n' registros de uma vez (carga em lote)
+    vetor = crescer_vetor(vetor, capacidade, *quantidade + n, tamanho_elemento, descricao); // Uma realocação no máximo
+    memcpy((char *)vetor + (size_t)*quantidade * tamanho_elemento, registros, (size_t)n * tamanho_elemento);
+    *quantidade += n;
+    return vetor;
 }
 
-int calcular_diferenca_dias(const char* data1_str, const char* data2_str) { // Diferença absoluta entre duas datas
-    int dia1, mes1, ano1, dia2, mes2, ano2; // Variáveis para armazenar componentes das datas
+//CONCORRENCIA (MODO SERVIDOR)
+// Menu, lote e benchmark usam as tabelas de uma única thread (acesso_exclusivo = 1) e não travam nada.
+// No servidor, cada comando roda com trava_estrutura: compartilhada para operações sobre quartos e
+// reservas existentes, exclusiva para cadastros, crescimento das tabelas, listagens completas e snapshot.
+// Listagens e exportações de reservas leem uma vista versionada (ver VISTA VERSIONADA DAS RESERVAS) e
+// ficam na trava compartilhada. Sob ela, cada quarto tem sua própria trava: reservas em quartos diferentes
+// andam em paralelo e duas reservas no mesmo quarto nunca se cruzam. Ordem das travas: quarto -> reservas ->
+// journal; quarto -> históricos; quarto -> calendário; quarto -> análise; vista -> reservas.
+int acesso_exclusivo = 1;               // 1 = nenhuma outra thread toca nas tabelas agora
+Trava trava_reservas = TRAVA_INICIAL;   // Anexação em reservas_hotel (ID e LSN na mesma ordem)
+Trava trava_historicos = TRAVA_INICIAL; // Históricos dos hóspedes
+Trava trava_calendario = TRAVA_INICIAL; // Bitmaps de ocupação e sua área de trabalho
+Trava trava_analise = TRAVA_INICIAL;    // Séries de ocupação e receita (quartos do mesmo tipo somam na mesma série)
+Trava trava_journal = TRAVA_INICIAL;    // Buffer e arquivo do journal (sempre travado: também é usado fora de trava_estrutura)
+Trava trava_vista = TRAVA_INICIAL;      // Vista atual de cada hotel e contagem de referências das vistas
+#ifdef PLATAFORMA_POSIX
+pthread_rwlock_t trava_estrutura = PTHREAD_RWLOCK_INITIALIZER; // Compartilhada x exclusiva, como descrito acima
+#endif
 
-    sscanf(data1_str, "%d/%d/%d", &dia1, &mes1, &ano1); // Extrai dia/mes/ano da string data1
-    sscanf(data2_str, "%d/%d/%d", &dia2, &mes2, &ano2); // Extrai dia/mes/ano da string data2
+void travar(Trava *trava) {               // Obtém a trava (sem pthreads, não faz nada)
+#ifdef PLATAFORMA_POSIX
+    pthread_mutex_lock(trava);
+#else
+    (void)trava;
+#endif
+}
 
-    long n_dias1 = contar_dias(dia1, mes1, ano1); // Converte data1 para dias absolutos
-    long n_dias2 = contar_dias(dia2, mes2, ano2); // Converte data2 para dias absolutos
+void destravar(Trava *trava) {
+#ifdef PLATAFORMA_POSIX
+    pthread_mutex_unlock(trava);
+#else
+    (void)trava;
+#endif
+}
 
-    // labs() retorna valor absoluto de long; diferença de dias positiva
-    return labs(n_dias2 - n_dias1);
+void travar_se_concorrente(Trava *trava) { // Só trava se outras threads usam as tabelas ao mesmo tempo
+    if (!acesso_exclusivo) travar(trava);
 }
 
-void realocar_quartos() {                // Realoca (ou aloca inicialmente) o array de quartos para +1 elemento
-    Quarto *temp = (Quarto *)realloc(quartos_hotel, (contador_quartos + 1) * sizeof(Quarto)); // realloc para (n+1)
+void destravar_se_concorrente(Trava *trava) {
+    if (!acesso_exclusivo) destravar(trava);
+}
 
-    if (temp == NULL) {                  // Verifica se a realocação falhou
-        printf("Erro fatal: Nao foi possivel alocar memoria para quarto!\n");
-        if (quartos_hotel != NULL) free(quartos_hotel); // Libera memória anterior, se houver
-        exit(1);                         // Encerra o programa devido ao erro crítico
+int *indice_id_crescer(int *indice, int *capacidade, int minimo, const char *descricao) { // Cobre IDs [0, minimo)
+    int capacidade_anterior = *capacidade;
+    indice = (int *)crescer_vetor(indice, capacidade, minimo, sizeof(int), descricao);
+    for (int i = capacidade_anterior; i < *capacidade; i++) {
+        indice[i] = -1;                    // Posições novas começam vazias
     }
-    quartos_hotel = temp;                // Atualiza ponteiro global para o novo bloco
+    return indice;
 }
 
-int verificar_quarto_existe(int numero_procurado) { // Verifica se já existe quarto com certo número
-    for (int i = 0; i < contador_quartos; i++) { // Percorre todos os quartos cadastrados
-        if (quartos_hotel[i].numero == numero_procurado) { // Se número bate, retorna 1 (existe)
-            return 1;
+int indice_id_buscar(const int *indice, int capacidade, int id) { // Índice do registro com esse ID, ou -1, em O(1)
+    return (id >= 0 && id < capacidade) ? indice[id] : -1;
+}
+
+void reservar_quartos(int adicionais) {   // Garante espaço para mais 'adicionais' quartos (e suas agendas)
+    Hotel *hotel = hotel_atual;
+    int capacidade_anterior = hotel->capacidade_quartos;
+    hotel->quartos_hotel = (Quarto *)crescer_vetor(hotel->quartos_hotel, &hotel->capacidade_quartos, hotel->contador_quartos + adicionais,
+                                                   sizeof(Quarto), "quarto");
+    if (hotel->capacidade_quartos != capacidade_anterior) { // Agenda acompanha o array de quartos
+        int capacidade_agendas = capacidade_anterior;
+        hotel->agendas_quartos = (AgendaQuarto *)crescer_vetor(hotel->agendas_quartos, &capacidade_agendas, hotel->capacidade_quartos,
+                                                               sizeof(AgendaQuarto), "agenda do quarto");
+        memset(&hotel->agendas_quartos[capacidade_anterior], 0,
+               (hotel->capacidade_quartos - capacidade_anterior) * sizeof(AgendaQuarto)); // Novas agendas começam vazias
+        int capacidade_travas = capacidade_anterior; // Travas também (só cresce sob acesso exclusivo: todas livres)
+        hotel->travas_quartos = (Trava *)crescer_vetor(hotel->travas_quartos, &capacidade_travas, hotel->capacidade_quartos,
+                                                       sizeof(Trava), "trava do quarto");
+        for (int i = capacidade_anterior; i < hotel->capacidade_quartos; i++) {
+            Trava livre = TRAVA_INICIAL;
+            hotel->travas_quartos[i] = livre;
         }
+        int capacidade_tipos_quartos = capacidade_anterior; // E o tipo de cada quarto
+        hotel->tipos_dos_quartos = (int *)crescer_vetor(hotel->tipos_dos_quartos, &capacidade_tipos_quartos, hotel->capacidade_quartos,
+                                                        sizeof(int), "tipo do quarto");
     }
-    return 0;                             // Retorna 0 se não encontrar
 }
 
-void cadastrar_quarto(){                  // Função que cadastra um novo quarto
-    realocar_quartos();                   // Garante espaço para um novo quarto
-
-    Quarto *novo_quarto = &quartos_hotel[contador_quartos]; // Ponteiro para o novo elemento
-    int escolha_status;                   // Variável para guardar status escolhido
-    int numero_digitado;                  // Variável para número do quarto digitado pelo usuário
+//EXECUCAO PARALELA (POOL DE THREADS)
+// executar_paralelo divide [0, total) em blocos contíguos e numerados; as threads do pool e a própria
+// thread chamadora pegam blocos até acabarem. Cada bloco escreve só na sua parte do resultado, e o
+// chamador junta as partes na ordem dos blocos: a saída é idêntica à da execução sequencial.
+#ifdef PLATAFORMA_POSIX
+typedef struct {                        // Estado do pool (uma tarefa por vez)
+    pthread_t threads[MAX_THREADS];      // Threads trabalhadoras (a chamadora também trabalha)
+    int num_threads;                     // Trabalhadoras criadas
+    pthread_mutex_t trava;               // Protege os campos abaixo
+    pthread_cond_t tem_trabalho;         // Sinaliza nova tarefa (ou encerramento)
+    pthread_cond_t terminou;             // Sinaliza o último bloco concluído
+    pthread_mutex_t uso;                 // Uma tarefa paralela por vez; concorrentes rodam sequencialmente
+    unsigned long geracao;               // Incrementada a cada tarefa publicada
+    int encerrar;                        // 1 = trabalhadoras devem sair
+    TarefaParalela tarefa;               // Tarefa atual
+    void *contexto;
+    Hotel *hotel;                        // hotel_atual da thread que publicou a tarefa
+    int total;                           // Elementos da tarefa atual
+    int num_blocos;                      // Blocos da tarefa atual
+    int proximo_bloco;                   // Próximo bloco a ser entregue
+    int blocos_concluidos;               // Blocos terminados
+} PoolThreads;
 
-    printf("\nCadastro de Quarto\n");     // Mensagem inicial
+PoolThreads pool = {.trava = PTHREAD_MUTEX_INITIALIZER, .tem_trabalho = PTHREAD_COND_INITIALIZER,
+                    .terminou = PTHREAD_COND_INITIALIZER, .uso = PTHREAD_MUTEX_INITIALIZER};
+int pool_iniciado = 0;                  // Trabalhadoras são criadas na primeira tarefa paralela
+pthread_once_t pool_inicio = PTHREAD_ONCE_INIT; // Uma só criação, sem travar pool.uso (blocos aninhados também planejam)
 
-    do {                                  // Loop para garantir número único
-        printf("Digite o numero do quarto: ");
-        scanf("%d", &numero_digitado);    // Lê número do quarto
-        if (verificar_quarto_existe(numero_digitado)) { // Se já existir, avisa
-            printf("ERRO: O quarto %d ja existe. Digite um numero unico.\n", numero_digitado);
+void pool_processar_blocos() {            // Pega e executa blocos da tarefa atual até não sobrar nenhum
+    pthread_mutex_lock(&pool.trava);
+    while (pool.proximo_bloco < pool.num_blocos) {
+        int bloco = pool.proximo_bloco++;
+        TarefaParalela tarefa = pool.tarefa;
+        void *contexto = pool.contexto;
+        hotel_atual = pool.hotel;          // Os blocos operam sobre o hotel de quem publicou a tarefa
+        int inicio = (int)((long long)pool.total * bloco / pool.num_blocos);
+        int fim = (int)((long long)pool.total * (bloco + 1) / pool.num_blocos);
+        pthread_mutex_unlock(&pool.trava);
+        tarefa(inicio, fim, bloco, contexto); // Fora da trava: blocos rodam em paralelo
+        pthread_mutex_lock(&pool.trava);
+        if (++pool.blocos_concluidos == pool.num_blocos) {
+            pthread_cond_broadcast(&pool.terminou);
         }
-    } while (verificar_quarto_existe(numero_digitado)); // Repetir enquanto número existir
-    novo_quarto->numero = numero_digitado; // Armazena número no novo quarto
-
-    printf("Digite o tipo do quarto (ex: Standard, Deluxe): ");
-    scanf("%s", novo_quarto->tipo);       // Lê tipo (palavra sem espaços) e armazena
-
-    printf("Digite o preco da diaria (ex: 150.00): ");
-    scanf("%f", &novo_quarto->preco_diaria); // Lê preço da diária e armazena
+    }
+    pthread_mutex_unlock(&pool.trava);
+}
 
-    do {                                  // Loop para validar entrada do status
-        printf("\nDigite o numero de acordo com o status do quarto:\n");
-        printf("0 - LIVRE\n1 - OCUPADO\n2 - MANUTENCAO\n");
-        printf("Escolha: ");
-        scanf("%d", &escolha_status);     // Lê escolha do usuário
-        if (escolha_status < 0 || escolha_status > 2) { // Verifica validade
-            printf("\nOpcao invalida. Digite novamente.\n");
+void *pool_trabalhadora(void *argumento) { // Laço de cada thread do pool
+    unsigned long vista = 0;             // Última geração processada
+    (void)argumento;
+    while (1) {
+        pthread_mutex_lock(&pool.trava);
+        while (pool.geracao == vista && !pool.encerrar) {
+            pthread_cond_wait(&pool.tem_trabalho, &pool.trava);
         }
-    } while (escolha_status < 0 || escolha_status > 2);
-    novo_quarto->status = escolha_status;  // Atribui status ao novo quarto
+        if (pool.encerrar) {
+            pthread_mutex_unlock(&pool.trava);
+            return NULL;
+        }
+        vista = pool.geracao;
+        pthread_mutex_unlock(&pool.trava);
+        pool_processar_blocos();
+    }
+}
 
-    contador_quartos++;                    // Incrementa contador global de quartos
-    printf("\nQuarto %d cadastrado com sucesso!\n", novo_quarto->numero); // Confirma cadastro
+void pool_iniciar() {                     // Cria as trabalhadoras: HOTEL_THREADS ou um por núcleo, menos a chamadora
+    long nucleos = sysconf(_SC_NPROCESSORS_ONLN);
+    const char *configurado = getenv("HOTEL_THREADS");
+    if (configurado != NULL && atoi(configurado) > 0) nucleos = atoi(configurado);
+    if (nucleos < 1) nucleos = 1;
+    if (nucleos > MAX_THREADS) nucleos = MAX_THREADS;
+    pool.num_threads = 0;
+    for (int i = 0; i < nucleos - 1; i++) {
+        if (pthread_create(&pool.threads[pool.num_threads], NULL, pool_trabalhadora, NULL) == 0) {
+            pool.num_threads++;
+        }
+    }
+    pool_iniciado = 1;
 }
 
-void listar_quartos() {                    // Função para listar todos os quartos cadastrados
-    printf("\n--- Lista de Quartos Cadastrados (%d no total) ---\n", contador_quartos); // Cabeçalho
-    if (contador_quartos == 0) {          // Se nenhum quarto cadastrado
-        printf("Nenhum quarto cadastrado ainda.\n");
-        return;
+void pool_encerrar() {                    // Encerra e aguarda as trabalhadoras
+    if (!pool_iniciado) return;
+    pthread_mutex_lock(&pool.trava);
+    pool.encerrar = 1;
+    pthread_cond_broadcast(&pool.tem_trabalho);
+    pthread_mutex_unlock(&pool.trava);
+    for (int i = 0; i < pool.num_threads; i++) {
+        pthread_join(pool.threads[i], NULL);
     }
+    pool_iniciado = 0;
+}
 
-    printf("Numero | Tipo          | Diaria   | Status\n"); // Títulos das colunas
-    printf("------------------------------------------------\n");
-    for (int i = 0; i < contador_quartos; i++) { // Percorre cada quarto
-        // Converte status numérico para string legível
-        const char* status_str = (quartos_hotel[i].status == LIVRE) ? "Livre" :
-                                 (quartos_hotel[i].status == OCUPADO) ? "Ocupado" :
-                                 (quartos_hotel[i].status == MANUTENCAO) ? "Manutencao" : "Desconhecido";
+int threads_disponiveis() {               // Threads que participam de uma tarefa paralela (inclui a chamadora)
+    pthread_once(&pool_inicio, pool_iniciar);
+    return pool.num_threads + 1;
+}
+#else
+int threads_disponiveis() {               // Sem pthreads: tudo roda na thread principal
+    return 1;
+}
 
-        printf("%-6d | %-13s | R$%-6.2f | %s\n",
-               quartos_hotel[i].numero,     // Exibe número do quarto
-               quartos_hotel[i].tipo,       // Exibe tipo
-               quartos_hotel[i].preco_diaria, // Exibe preço formatado
-               status_str);                 // Exibe status em texto
-    }
+void pool_encerrar() {
 }
+#endif
 
-void realocar_hospedes() {                 // Realoca (ou aloca) o array de hóspedes para +1
-    Hospede *temp = (Hospede *)realloc(hospedes_hotel, (contador_hospedes + 1) * sizeof(Hospede));
-    if (temp == NULL) {                    // Checa falha de alocação
-        printf("Erro fatal: Nao foi possivel alocar memoria para hospede!\n");
-        if (hospedes_hotel != NULL) free(hospedes_hotel); // Libera memória anterior, se houver
-        exit(1);                           // Finaliza o programa
-    }
-    hospedes_hotel = temp;                 // Atualiza ponteiro global
+int planejar_blocos(int total, int minimo_por_bloco) { // Quantos blocos usar para 'total' elementos
+    int blocos = total / minimo_por_bloco; // Cada bloco precisa de trabalho suficiente para compensar
+    int limite = threads_disponiveis() * BLOCOS_POR_THREAD;
+    if (blocos > limite) blocos = limite;
+    return (blocos < 1) ? 1 : blocos;
 }
 
-int verificar_hospede_existe(char* cpf_procurado) { // Verifica se CPF já está cadastrado
-    for (int i = 0; i < contador_hospedes; i++) {
-        if (strcmp(hospedes_hotel[i].cpf, cpf_procurado) == 0) { // Comparação de strings
-            return 1;                      // Retorna 1 se encontrar
+void executar_paralelo(int total, int num_blocos, TarefaParalela tarefa, void *contexto) { // Roda os blocos e espera todos
+#ifdef PLATAFORMA_POSIX
+    if (num_blocos > 1 && pthread_mutex_trylock(&pool.uso) == 0) { // Pool livre: distribui os blocos
+        pthread_once(&pool_inicio, pool_iniciar);
+        pthread_mutex_lock(&pool.trava);
+        pool.tarefa = tarefa;
+        pool.contexto = contexto;
+        pool.hotel = hotel_atual;
+        pool.total = total;
+        pool.num_blocos = num_blocos;
+        pool.proximo_bloco = 0;
+        pool.blocos_concluidos = 0;
+        pool.geracao++;
+        pthread_cond_broadcast(&pool.tem_trabalho);
+        pthread_mutex_unlock(&pool.trava);
+
+        pool_processar_blocos();           // A chamadora também trabalha
+
+        pthread_mutex_lock(&pool.trava);
+        while (pool.blocos_concluidos < pool.num_blocos) {
+            pthread_cond_wait(&pool.terminou, &pool.trava);
         }
+        pthread_mutex_unlock(&pool.trava);
+        pthread_mutex_unlock(&pool.uso);
+        return;
+    }
+#endif
+    for (int bloco = 0; bloco < num_blocos; bloco++) { // Sequencial: mesmos blocos, na ordem
+        tarefa((int)((long long)total * bloco / num_blocos), (int)((long long)total * (bloco + 1) / num_blocos),
+               bloco, contexto);
     }
-    return 0;                              // Retorna 0 caso contrário
 }
 
-int buscar_hospede_por_cpf(char* cpf_procurado) { // Retorna índice do hóspede pelo CPF
-    for (int i = 0; i < contador_hospedes; i++) {
-        if (strcmp(hospedes_hotel[i].cpf, cpf_procurado) == 0) { // Igualdade de CPF?
-            return i;                      // Retorna índice no array
+void texto_bloco_printf(TextoBloco *texto, const char *formato, ...) { // printf para o texto de um bloco
+    va_list argumentos;
+    while (1) {
+        int livre = texto->capacidade - texto->usado;
+        va_start(argumentos, formato);
+        int escritos = vsnprintf(texto->dados + texto->usado, livre, formato, argumentos);
+        va_end(argumentos);
+        if (escritos < 0) return;
+        if (escritos < livre) {            // Coube (vsnprintf precisa de espaço para o '\0')
+            texto->usado += escritos;
+            return;
         }
+        texto->dados = (char *)crescer_vetor(texto->dados, &texto->capacidade, texto->usado + escritos + 1,
+                                             1, "texto de bloco");
     }
-    return -1;                             // Retorna -1 se não encontrar
 }
 
-void cadastrar_hospede(){                  // Função para cadastrar novo hóspede
-    realocar_hospedes();                   // Garante espaço para +1 hóspede
-    Hospede *novo_hospede = &hospedes_hotel[contador_hospedes]; // Ponteiro para novo elemento
-    char cpf_digitado[TAM_CPF];            // Buffer local para CPF digitado
-
-    printf("\nCadastro de Hospede\n");     // Cabeçalho
-
-    do {                                   // Loop para garantir CPF único
-        printf("Digite o CPF (apenas numeros): ");
-        scanf("%s", cpf_digitado);         // Lê CPF como string
+//JOURNAL (LOG DE ESCRITA ANTECIPADA COM CONFIRMACAO EM GRUPO)
+FILE *arquivo_journal = NULL;           // Journal aberto para acréscimo; NULL = alterações não são registradas
+long long ultimo_lsn = 0;               // LSN do último registro gerado (ou aplicado na recuperação)
+char buffer_journal[TAM_BUFFER_JOURNAL]; // Registros ainda não gravados
+size_t usado_journal = 0;               // Bytes ocupados em buffer_journal
+int pendentes_journal = 0;              // Registros aguardando a próxima confirmação
 
-        if (verificar_hospede_existe(cpf_digitado)) { // Se CPF já existe, avisa
-            printf("ERRO: O CPF %s ja esta cadastrado.\n", cpf_digitado);
-        }
-    } while (verificar_hospede_existe(cpf_digitado)); // Repetir enquanto CPF existir
-    strcpy(novo_hospede->cpf, cpf_digitado); // Copia CPF para estrutura do hóspede
+unsigned int verificacao_journal(const CabecalhoJournal *cabecalho, const void *conteudo) { // FNV-1a de cabeçalho + conteúdo
+    CabecalhoJournal copia = *cabecalho;
+    copia.verificacao = 0;                // O próprio campo não entra na conta
+    unsigned int h = 2166136261U;
+    const unsigned char *bytes = (const unsigned char *)&copia;
+    for (size_t i = 0; i < sizeof(copia); i++) h = (h ^ bytes[i]) * 16777619U;
+    bytes = (const unsigned char *)conteudo;
+    for (size_t i = 0; i < cabecalho->tamanho; i++) h = (h ^ bytes[i]) * 16777619U;
+    return h;
+}
 
-    printf("Digite o nome: ");
-    scanf("%s", novo_hospede->nome);       // Lê nome (sem espaços) e armazena
+void journal_gravar_grupo() {              // Grava os registros pendentes e força-os ao disco (com trava_journal)
+    if (arquivo_journal == NULL || usado_journal == 0) {
+        return;
+    }
+    if (fwrite(buffer_journal, 1, usado_journal, arquivo_journal) != usado_journal || fflush(arquivo_journal) != 0) {
+        fprintf(stderr, "Erro fatal: Nao foi possivel gravar o journal!\n");
+        exit(1);                           // Sem journal não há como garantir as reservas já confirmadas
+    }
+#ifdef PLATAFORMA_POSIX
+    if (fsync(fileno(arquivo_journal)) != 0) { // Um fsync cobre todo o grupo; se falhar, nada do grupo está confirmado
+        fprintf(stderr, "Erro fatal: Nao foi possivel gravar o journal!\n");
+        exit(1);
+    }
+#endif
+    usado_journal = 0;
+    pendentes_journal = 0;
+}
 
-    printf("Digite o telefone: ");
-    scanf("%s", novo_hospede->telefone);   // Lê telefone e armazena
+void journal_confirmar() {                // Confirma o grupo pendente com um único fsync
+    if (arquivo_journal == NULL) {
+        return;
+    }
+    travar(&trava_journal);                // No servidor, clientes que chegam durante o fsync entram no próximo grupo
+    journal_gravar_grupo();
+    destravar(&trava_journal);
+}
 
-    novo_hospede->id_hospede = contador_hospedes + 1; // Atribui ID sequencial
-    novo_hospede->historico_ids_reservas = NULL; // Inicializa histórico vazio
-    novo_hospede->num_reservas_historico = 0;   // Inicializa contagem do histórico
-    contador_hospedes++;                 // Incrementa contador global de hóspedes
-    printf("\nHospede %s cadastrado com sucesso! ID: %d\n", novo_hospede->nome, novo_hospede->id_hospede); // Confirma
+void journal_registrar(int tipo, const void *conteudo, unsigned int tamanho) { // Acrescenta um registro ao grupo pendente
+    if (arquivo_journal == NULL) {         // Journal desligado (modo lote sem persistência, ou reaplicação)
+        return;
+    }
+    travar(&trava_journal);
+    if (usado_journal + sizeof(CabecalhoJournal) + tamanho > TAM_BUFFER_JOURNAL) {
+        journal_gravar_grupo();            // Buffer cheio: confirma o grupo atual antes
+    }
+    CabecalhoJournal cabecalho;
+    memset(&cabecalho, 0, sizeof(cabecalho));
+    cabecalho.tamanho = tamanho;
+    cabecalho.lsn = ++ultimo_lsn;
+    cabecalho.tipo = tipo;
+    cabecalho.hotel = (int)(hotel_atual - hoteis); // A reaplicação refaz a alteração no mesmo hotel
+    cabecalho.verificacao = verificacao_journal(&cabecalho, conteudo);
+    memcpy(buffer_journal + usado_journal, &cabecalho, sizeof(cabecalho));
+    memcpy(buffer_journal + usado_journal + sizeof(cabecalho), conteudo, tamanho);
+    usado_journal += sizeof(cabecalho) + tamanho;
+    if (++pendentes_journal >= JOURNAL_GRUPO) { // Grupo completo: confirma
+        journal_gravar_grupo();
+    }
+    destravar(&trava_journal);
 }
 
-void listar_hospedes() {                  // Lista todos os hóspedes cadastrados
-    printf("\n--- Lista de Hospedes Cadastrados (%d no total) ---\n", contador_hospedes); // Cabeçalho
-    if (contador_hospedes == 0) {         // Se não há hóspedes
-        printf("Nenhum hospede cadastrado ainda.\n");
+//SAIDA COM BUFFER
+void saida_descarregar(BufferSaida *saida) { // Escreve o conteúdo acumulado no destino
+    journal_confirmar();                   // Nenhum "OK" sai antes de a alteração estar em disco
+    if (saida->arquivo == NULL) {          // Saída descartada (medições do benchmark)
+        saida->usado = 0;
         return;
     }
-    printf("ID   | Nome          | CPF            | Telefone       | Historico Reservas\n"); // Títulos
-    printf("----------------------------------------------------------------------------\n");
-    for (int i = 0; i < contador_hospedes; i++) { // Percorre o array de hóspedes
-        printf("%-4d | %-13s | %-14s | %-14s | Total: %d\n",
-               hospedes_hotel[i].id_hospede,      // Exibe ID do hóspede
-               hospedes_hotel[i].nome,            // Exibe nome
-               hospedes_hotel[i].cpf,             // Exibe CPF
-               hospedes_hotel[i].telefone,        // Exibe telefone
-               hospedes_hotel[i].num_reservas_historico); // Exibe número de reservas no histórico
+    if (saida->usado > 0) {
+        fwrite(saida->dados, 1, saida->usado, saida->arquivo);
+        saida->usado = 0;
     }
+    fflush(saida->arquivo);
 }
-void atualizar_status_quarto(int numero_quarto, int novo_status) { // Atualiza status do quarto pelo número
-    for (int i = 0; i < contador_quartos; i++) { // Percorre quartos
-        if (quartos_hotel[i].numero == numero_quarto) { // Se encontra o quarto desejado
-            quartos_hotel[i].status = novo_status; // Atualiza o status
-            return;                         // Sai da função
-        }
+
+void saida_escrever(BufferSaida *saida, const char *dados, size_t tamanho) { // Acrescenta bytes já formatados
+    while (tamanho > 0) {
+        size_t livre = TAM_BUFFER_SAIDA - saida->usado;
+        size_t parte = (tamanho < livre) ? tamanho : livre;
+        memcpy(saida->dados + saida->usado, dados, parte);
+        saida->usado += parte;
+        dados += parte;
+        tamanho -= parte;
+        if (saida->usado == TAM_BUFFER_SAIDA) saida_descarregar(saida); // Buffer cheio: esvazia e continua
     }
 }
 
-int buscar_quarto_por_numero(int num_procurado) { // Retorna índice do quarto dado o número
-     for (int i = 0; i < contador_quartos; i++) { // Percorre array de quartos
-        if (quartos_hotel[i].numero == num_procurado) { // Comparação do número
-            return i;                         // Retorna índice se encontrado
-        }
+void saida_printf(BufferSaida *saida, const char *formato, ...) { // printf para o buffer de saída
+    va_list argumentos;
+    size_t livre = TAM_BUFFER_SAIDA - saida->usado;
+    va_start(argumentos, formato);
+    int escritos = vsnprintf(saida->dados + saida->usado, livre, formato, argumentos);
+    va_end(argumentos);
+    if (escritos < 0) return;              // Erro de formatação: nada a acrescentar
+    if ((size_t)escritos < livre) {        // Coube no espaço restante
+        saida->usado += escritos;
+        return;
     }
-    return -1;                                // Retorna -1 se não encontrado
+    saida_descarregar(saida);              // Não coube: esvazia o buffer e formata de novo
+    va_start(argumentos, formato);
+    if ((size_t)escritos < TAM_BUFFER_SAIDA) {
+        saida->usado = vsnprintf(saida->dados, TAM_BUFFER_SAIDA, formato, argumentos);
+    } else {
+        if (saida->arquivo != NULL) vfprintf(saida->arquivo, formato, argumentos); // Texto maior que o buffer inteiro: vai direto
+    }
+    va_end(argumentos);
+}
+
+//INSTRUMENTACAO (CONTADORES E HISTOGRAMAS DE LATENCIA)
+// Cada operação instrumentada conta chamadas e elementos examinados; parte das chamadas é cronometrada
+// (todas nas operações de microssegundos, 1 a cada 8 ou 64 nas mais rápidas) e entra em um histograma de
+// faixas de potência de 2. No servidor os contadores são somas atômicas relaxadas (nada é travado para
+// medir); com acesso exclusivo são somas comuns.
+// Compilar com -DSEM_INSTRUMENTACAO remove tudo: MEDIR_INICIO/MEDIR_FIM viram código vazio.
+long long relogio_ns() {                   // Relógio monotônico em nanossegundos (inteiro)
+#ifdef PLATAFORMA_POSIX
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1000000000LL + t.tv_nsec;
+#else
+    return (long long)((double)clock() * (1e9 / CLOCKS_PER_SEC));
+#endif
 }
 
-void realocar_reservas() {                   // Realoca (ou aloca) array de reservas para +1
-    Reserva *temp = (Reserva *)realloc(reservas_hotel, (contador_reservas + 1) * sizeof(Reserva));
-    if (temp == NULL) {                      // Verifica falha de alocação
-        printf("Erro fatal: Nao foi possivel alocar memoria para reserva!\n");
-        if (reservas_hotel != NULL) free(reservas_hotel); // Libera bloco anterior, se houver
-        exit(1);                             // Finaliza por erro crítico
+#ifndef SEM_INSTRUMENTACAO
+Medida medidas[NUM_MEDIDAS];            // Contadores de cada operação (índice MEDIDA_*)
+const char *nomes_medidas[NUM_MEDIDAS] = {"buscar quarto", "buscar hospede", "criar reserva", "alterar reserva",
+                                          "quarto disponivel", "quartos disponiveis", "salvar snapshot",
+                                          "carregar snapshot", "mais baratos", "buscar nome", "alocar grupo"};
+const unsigned long long amostragem_medidas[NUM_MEDIDAS] = {63, 63, 7, 7, 63, 0, 0, 0, 0, 0, 0}; // Cronometra 1 a cada (máscara + 1) chamadas
+
+unsigned long long somar_contador(unsigned long long *contador, unsigned long long valor) { // Soma; devolve o valor anterior
+#ifdef PLATAFORMA_POSIX
+    if (!acesso_exclusivo) {               // Outras threads medem ao mesmo tempo
+        return __atomic_fetch_add(contador, valor, __ATOMIC_RELAXED);
     }
-    reservas_hotel = temp;                   // Atualiza ponteiro global
+#endif
+    unsigned long long anterior = *contador;
+    *contador = anterior + valor;
+    return anterior;
 }
-void realizar_reserva() {                    // Função para criar uma nova reserva
-    char cpf_busca[TAM_CPF];                 // Buffer para CPF informado
-    int indice_hospede;                      // Índice do hóspede no array
-    int numero_quarto_escolhido;             // Número do quarto escolhido
-    char checkin_str[TAM_DATA];              // String do check-in
-    char checkout_str[TAM_DATA];             // String do check-out
-    int indice_quarto;                       // Índice do quarto no array
-    int validacao = 0;                       // Flag de validação do quarto
-    int verificar_datas = 0;                 // Flag para validação das datas
-    float preco_diaria_quarto;               // Preço da diária do quarto selecionado
-    int dias_estadia;                        // Dias calculados entre checkin e checkout
 
-    printf("\nREALIZAR RESERVA\n");
-    if(contador_quartos ==0){                // Se não há quartos cadastrados, aborta operação
-        printf("Nenhum quarto cadastrado no sistema\n");
+void contador_maximo(unsigned long long *contador, unsigned long long valor) { // *contador = max(*contador, valor)
+#ifdef PLATAFORMA_POSIX
+    if (!acesso_exclusivo) {
+        unsigned long long atual = __atomic_load_n(contador, __ATOMIC_RELAXED);
+        while (valor > atual && !__atomic_compare_exchange_n(contador, &atual, valor, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        }                                  // Outra thread mudou o máximo: 'atual' foi relido, tenta de novo
         return;
     }
+#endif
+    if (valor > *contador) *contador = valor;
+}
+#define MEDIR_INICIO(medida) long long inicio_medida = medida_iniciar(medida)
+#define MEDIR_FIM(medida, elementos) medida_finalizar((medida), inicio_medida, (elementos))
 
-    do {                                     // Loop para encontrar hóspede existente
-        printf("Digite o CPF do hospede (apenas numeros, ou '0' para cancelar): ");
-        scanf("%s", cpf_busca);              // Lê CPF ou '0' para cancelar
+long long medida_iniciar(int medida) {     // Conta a chamada; devolve o instante inicial, ou 0 se não for cronometrada
+    unsigned long long anteriores = somar_contador(&medidas[medida].chamadas, 1);
+    return (anteriores & amostragem_medidas[medida]) == 0 ? relogio_ns() : 0;
+}
 
-        if (strcmp(cpf_busca, "0") == 0) {   // Se usuário optou por cancelar
-            printf("Operacao de reserva cancelada.\n");
-            return;
-        }
+void medida_finalizar(int medida, long long inicio, long long elementos) { // Soma elementos e, se cronometrada, a latência
+    Medida *m = &medidas[medida];
+    somar_contador(&m->elementos, (unsigned long long)elementos);
+    if (inicio == 0) return;
+    unsigned long long ns = (unsigned long long)(relogio_ns() - inicio);
+    int faixa = 0;
+    while (faixa < NUM_FAIXAS_LATENCIA - 1 && (ns >> faixa) != 0) faixa++; // Menor k com ns < 2^k
+    somar_contador(&m->amostras, 1);
+    somar_contador(&m->soma_ns, ns);
+    somar_contador(&m->faixas[faixa], 1);
+    contador_maximo(&m->maximo_ns, ns);
+}
 
-        indice_hospede = buscar_hospede_por_cpf(cpf_busca); // Busca hóspede pelo CPF
+unsigned long long medida_percentil(const Medida *m, int percentual) { // Limite superior da faixa que contém o percentil
+    unsigned long long alvo = (m->amostras * percentual + 99) / 100, acumulado = 0;
+    for (int k = 0; k < NUM_FAIXAS_LATENCIA; k++) {
+        acumulado += m->faixas[k];
+        if (acumulado >= alvo && acumulado > 0) return 1ULL << k;
+    }
+    return 0;
+}
 
-        if (indice_hospede == -1) {         // Se não encontrado, avisa e repete
-            printf("ERRO: Hospede nao cadastrado. Tente novamente ou digite '0' para sair.\n");
+void escrever_medidas(BufferSaida *saida) { // Tabela de contadores e histogramas (leitura sob acesso exclusivo)
+    saida_printf(saida, "\n--- MEDIDAS DE DESEMPENHO ---\n");
+    saida_printf(saida, "%-20s | %12s | %14s | %10s | %10s | %10s | %10s | %11s\n", "Operacao", "Chamadas",
+                 "Elementos", "Amostras", "Media (ns)", "p50 (ns)", "p99 (ns)", "Max (ns)");
+    for (int i = 0; i < NUM_MEDIDAS; i++) { // p50/p99: limite superior da faixa do histograma
+        const Medida *m = &medidas[i];
+        saida_printf(saida, "%-20s | %12llu | %14llu | %10llu | %10llu | %10llu | %10llu | %11llu\n", nomes_medidas[i],
+                     m->chamadas, m->elementos, m->amostras, m->amostras ? m->soma_ns / m->amostras : 0ULL,
+                     medida_percentil(m, 50), medida_percentil(m, 99), m->maximo_ns);
+    }
+    for (int i = 0; i < NUM_MEDIDAS; i++) { // Histogramas: uma linha por operação, só faixas não vazias
+        if (medidas[i].amostras == 0) continue;
+        saida_printf(saida, "%s:", nomes_medidas[i]);
+        for (int k = 0; k < NUM_FAIXAS_LATENCIA; k++) {
+            if (medidas[i].faixas[k] != 0) saida_printf(saida, " <%lluns=%llu", 1ULL << k, medidas[i].faixas[k]);
         }
-    } while (indice_hospede == -1);         // Repete até encontrar hóspede ou cancelar
-
-    do{                                      // Loop para selecionar quarto disponível
-        printf("QUARTOS DISPONIVEIS\n");
-        listar_quartos();                    // Exibe lista de quartos
+        saida_printf(saida, "\n");
+    }
+}
 
-        printf("\nDIGITE O NUMERO DO QUARTO ESCOLHIDO (ou caso queira cancelar a reserva digite 0):\n");
-        scanf("%d", &numero_quarto_escolhido); // Lê número do quarto escolhido
+void zerar_medidas() {                    // Recomeça todas as contagens (sob acesso exclusivo)
+    memset(medidas, 0, sizeof(medidas));
+}
+#else
+#define MEDIR_INICIO(medida)
+#define MEDIR_FIM(medida, elementos) ((void)(elementos))
 
-        if(numero_quarto_escolhido == 0){    // Se usuário cancelar a seleção
-            printf("RESERVA CANCELADA\n");
-            return;
-        }
+void escrever_medidas(BufferSaida *saida) {
+    saida_printf(saida, "\nInstrumentacao desativada (compilado com SEM_INSTRUMENTACAO).\n");
+}
 
-        indice_quarto = buscar_quarto_por_numero(numero_quarto_escolhido); // Busca índice do quarto
-        if (indice_quarto == -1) {          // Quarto não existe?
-            printf("ERRO: Quarto %d nao existe. Tente novamente.\n", numero_quarto_escolhido);
-            validacao = 0; 
-        } 
-        else if (quartos_hotel[indice_quarto].status != LIVRE) { // Se não estiver livre
-            printf("ERRO: Quarto %d esta ocupado ou em manutencao. Tente novamente.\n", numero_quarto_escolhido);
-            validacao = 0; 
-        } 
-        else{
-            validacao = 1;                   // Quarto válido e livre
-        }
-    }while (validacao == 0);                // Repete enquanto não for válido
-    
-    preco_diaria_quarto = quartos_hotel[indice_quarto].preco_diaria; // Pega preço da diária
+void zerar_medidas() {
+}
+#endif
 
-    do{                                      // Loop para validar datas
-        printf("Digite a data de Check-in (DD/MM/AAAA): ");
-        scanf("%s", checkin_str);            // Lê check-in
-        printf("Digite a data de Check-out (DD/MM/AAAA): ");
-        scanf("%s", checkout_str);           // Lê check-out
-        dias_estadia = calcular_diferenca_dias(checkin_str, checkout_str); // Calcula diferença de dias
-        if (dias_estadia <= 0) {            // Verifica se check-out é posterior a check-in
-            printf("ERRO: A data de check-out deve ser posterior a de check-in. Tente novamente\n");
-            verificar_datas = 1;
-        }else{
-            verificar_datas = 0;
-        }
-    }while(verificar_datas == 1);           // Repete enquanto datas inválidas
-   
-    float valor_total = preco_diaria_quarto * dias_estadia; // Calcula valor total da reserva
-
-    realocar_reservas();                     // Realoca array de reservas para adicionar nova
-    Reserva *nova_reserva = &reservas_hotel[contador_reservas]; // Ponteiro para a nova reserva
-    nova_reserva->id_reserva = contador_reservas + 1; // Atribui ID sequencial
-    nova_reserva->numero_quarto = numero_quarto_escolhido; // Guarda número do quarto
-    nova_reserva->id_hospede = hospedes_hotel[indice_hospede].id_hospede; // Liga ao hóspede
-    strcpy(nova_reserva->data_checkin, checkin_str); // Armazena data check-in
-    strcpy(nova_reserva->data_checkout, checkout_str); // Armazena data check-out
-    nova_reserva->status_reserva = ATIVA;    // Marca reserva como ATIVA
-    nova_reserva->valor_total = valor_total; // Armazena valor total calculado
-    atualizar_status_quarto(numero_quarto_escolhido, OCUPADO); // Marca quarto como OCUPADO
-    contador_reservas++;                     // Incrementa contador de reservas
-    printf("\nReserva %d realizada com sucesso para %s no Quarto %d.\n", nova_reserva->id_reserva, hospedes_hotel[indice_hospede].nome, numero_quarto_escolhido); // Mensagem de sucesso
-    printf("Estadia de %d dias. Valor total: R$%.2f\n", dias_estadia, valor_total); // Mostra resumo da reserva
+//AGENDA DE OCUPACAO POR QUARTO
+void agenda_recalcular_maximos(AgendaQuarto *agenda, int inicio) { // Refaz o prefixo de max_checkout a partir de 'inicio'
+    for (int i = inicio; i < agenda->num_intervalos; i++) {
+        long anterior = (i > 0) ? agenda->intervalos[i-1].max_checkout : LONG_MIN; // Máximo acumulado até o anterior (datas antes de 1970 são negativas)
+        long atual = agenda->intervalos[i].checkout;
+        agenda->intervalos[i].max_checkout = (atual > anterior) ? atual : anterior;
+    }
 }
 
-void listar_reservas_ativas() {             // Lista reservas que estão com status ATIVA
-    printf("\n--- Lista de Reservas Ativas (%d no total) ---\n", contador_reservas); // Cabeçalho (observação: mostra total de reservas, não só ativas)
-    if (contador_reservas == 0) { printf("Nenhuma reserva ativa.\n"); return; } // Se não há reservas cadastradas
-    printf("ID Res. | Quarto | ID Hosp. | Check-In   | Check-Out  | Valor Total | Status\n");
-    printf("----------------------------------------------------------------------------------\n");
-    for (int i = 0; i < contador_reservas; i++) { // Percorre todas as reservas
-        if (reservas_hotel[i].status_reserva == ATIVA) { // Mostra somente as ATIVAS
-             printf("%-7d | %-6d | %-8d | %-10s | %-10s | R$%-8.2f | Ativa\n",
-                   reservas_hotel[i].id_reserva,       // ID da reserva
-                   reservas_hotel[i].numero_quarto,    // Número do quarto
-                   reservas_hotel[i].id_hospede,       // ID do hóspede
-                   reservas_hotel[i].data_checkin,     // Check-in
-                   reservas_hotel[i].data_checkout,    // Check-out
-                   reservas_hotel[i].valor_total);     // Valor total
+int agenda_contar_antes(const AgendaQuarto *agenda, long dia) { // Quantos intervalos têm checkin < dia (busca binária)
+    int ini = 0, fim = agenda->num_intervalos; // Intervalo de busca [ini, fim)
+    while (ini < fim) {
+        int meio = ini + (fim - ini) / 2;
+        if (agenda->intervalos[meio].checkin < dia) {
+            ini = meio + 1;                // Resposta está à direita
+        } else {
+            fim = meio;                    // Resposta está à esquerda (ou é o meio)
         }
     }
+    return ini;
 }
 
-void adicionar_reserva_ao_historico(int id_hospede, int id_reserva) { // Adiciona ID da reserva ao histórico do hóspede
-    int index = -1;                        // Índice local do hóspede
+void agenda_inserir(int indice_quarto, long checkin, long checkout, int id_reserva) { // Insere intervalo mantendo a ordem
+    AgendaQuarto *agenda = &hotel_atual->agendas_quartos[indice_quarto]; // Agenda do quarto
+    agenda->intervalos = (IntervaloReserva *)crescer_vetor(agenda->intervalos, &agenda->capacidade,
+                                                           agenda->num_intervalos + 1, sizeof(IntervaloReserva),
+                                                           "agenda do quarto");
 
-    for (int i = 0; i < contador_hospedes; i++) { // Encontra o hóspede pelo ID
-        if (hospedes_hotel[i].id_hospede == id_hospede) {
-            index = i;
-            break;
+    int pos = agenda_contar_antes(agenda, checkin + 1); // Depois de todos com checkin <= novo checkin
+    memmove(&agenda->intervalos[pos + 1], &agenda->intervalos[pos],
+            (agenda->num_intervalos - pos) * sizeof(IntervaloReserva)); // Abre espaço na posição
+    agenda->intervalos[pos].checkin = checkin;
+    agenda->intervalos[pos].checkout = checkout;
+    agenda->intervalos[pos].id_reserva = id_reserva;
+    agenda->num_intervalos++;
+    agenda_recalcular_maximos(agenda, pos); // Só o sufixo a partir da inserção muda
+}
+
+void agenda_remover_posicao(AgendaQuarto *agenda, int i) { // Retira o intervalo da posição 'i'
+    memmove(&agenda->intervalos[i], &agenda->intervalos[i + 1],
+            (agenda->num_intervalos - i - 1) * sizeof(IntervaloReserva)); // Fecha o buraco
+    agenda->num_intervalos--;
+    agenda_recalcular_maximos(agenda, i);
+}
+
+void agenda_remover(int indice_quarto, int id_reserva) { // Remove da agenda o intervalo de uma reserva
+    AgendaQuarto *agenda = &hotel_atual->agendas_quartos[indice_quarto];
+    for (int i = 0; i < agenda->num_intervalos; i++) {
+        if (agenda->intervalos[i].id_reserva == id_reserva) { // Intervalo da reserva encontrado
+            agenda_remover_posicao(agenda, i);
+            return;
+        }
     }
 }
-    if (index == -1) return;               // Se não encontrou hóspede, sai
 
-    Hospede *h = &hospedes_hotel[index];   // Ponteiro para o hóspede encontrado
+int agenda_conflita(const AgendaQuarto *agenda, long checkin, long checkout) { // 1 se [checkin,checkout) sobrepõe algum intervalo
+    int p = agenda_contar_antes(agenda, checkout); // Só intervalos que começam antes do checkout podem sobrepor
+    if (p == 0) return 0;                  // Nenhum começa antes: sem conflito
+    return agenda->intervalos[p-1].max_checkout > checkin; // Algum deles termina depois do checkin?
+}
+
+int quarto_livre_periodo(int indice_quarto, long checkin, long checkout) { // Em operação e sem reserva nem bloqueio no período
+    const Hotel *hotel = hotel_atual;
+    return hotel->quartos_hotel[indice_quarto].status == LIVRE &&
+           !agenda_conflita(&hotel->agendas_quartos[indice_quarto], checkin, checkout);
+}
 
-    h->historico_ids_reservas = realloc(    // Realoca array de IDs no histórico para +1
-        h->historico_ids_reservas,
-        (h->num_reservas_historico + 1) * sizeof(int)
-    );
+int status_quarto_em(int indice_quarto, long dia) { // LIVRE, OCUPADO ou MANUTENCAO na noite 'dia', derivado da agenda
+    const Hotel *hotel = hotel_atual;
+    int status = hotel->quartos_hotel[indice_quarto].status; // Fora de operação no cadastro: vale para qualquer data
+    if (status != LIVRE) return status;
+    const AgendaQuarto *agenda = &hotel->agendas_quartos[indice_quarto];
+    // Só intervalos com checkin <= dia podem cobrir a noite; o máximo acumulado encerra a busca cedo
+    for (int k = agenda_contar_antes(agenda, dia + 1) - 1; k >= 0 && agenda->intervalos[k].max_checkout > dia; k--) {
+        if (agenda->intervalos[k].checkout <= dia) continue;
+        if (agenda->intervalos[k].id_reserva == BLOQUEIO_MANUTENCAO) return MANUTENCAO;
+        status = OCUPADO;                  // Continua: um bloqueio na mesma noite prevalece
+    }
+    return status;
+}
 
-    h->historico_ids_reservas[h->num_reservas_historico] = id_reserva; // Armazena novo ID
-    h->num_reservas_historico++;         // Incrementa contagem do histórico
+int quarto_disponivel_indice(int indice_quarto, long checkin, long checkout) { // Disponibilidade pelo índice do quarto, O(log k)
+    Hotel *hotel = hotel_atual;
+    MEDIR_INICIO(MEDIDA_QUARTO_DISPONIVEL);
+    int disponivel = quarto_livre_periodo(indice_quarto, checkin, checkout);
+    MEDIR_FIM(MEDIDA_QUARTO_DISPONIVEL, hotel->agendas_quartos[indice_quarto].num_intervalos); // Intervalos considerados na busca
+    return disponivel;
 }
 
+//CALENDARIO DE OCUPACAO (BITMAPS POR NOITE)
+// Uma linha de bits por noite da janela [calendario_inicio, calendario_inicio + HORIZONTE_CALENDARIO):
+// o bit i da linha está ligado se o quarto de índice i está reservado naquela noite. A consulta de um
+// período faz o OR das linhas das noites e lê de uma vez o conjunto de quartos livres (bits desligados).
 
-void gerenciar_reserva(){                  // Função para cancelar ou concluir reservas ativas
-    int id_reserva_alvo;                   // ID da reserva alvo informado pelo usuário
-    int quarto_associado;                  // Número do quarto associado à reserva
-    int encontrado = 0;                    // Flag para controlar busca
-    int sub_opcao = 0;                     // Escolha do usuário (cancelar/concluir)
-    int novo_status_reserva;               // Novo status a ser aplicado
+long dia_hoje() {                         // Dia absoluto de hoje (mesma origem de contar_dias)
+    return (long)(time(NULL) / 86400);
+}
 
-    printf("\nGERENCIAR RESERVAS ATIVAS\n");
-     if (contador_reservas == 0) {         // Se não há reservas no sistema
-        printf("Nenhuma reserva ativa no sistema.\n");
-        return;
+void calendario_marcar_faixa(int indice_quarto, long checkin, long checkout) { // Liga os bits das noites [checkin, checkout) na janela
+    Hotel *hotel = hotel_atual;
+    long inicio = checkin - hotel->calendario_inicio;
+    long fim = checkout - hotel->calendario_inicio;
+    if (inicio < 0) inicio = 0;           // Só a parte do intervalo que cai na janela
+    if (fim > HORIZONTE_CALENDARIO) fim = HORIZONTE_CALENDARIO;
+    unsigned long long bit = 1ULL << (indice_quarto & 63);
+    unsigned long long *coluna = hotel->calendario_ocupacao + (indice_quarto >> 6);
+    for (long noite = inicio; noite < fim; noite++) {
+        coluna[noite * hotel->palavras_por_noite] |= bit;
     }
-    listar_reservas_ativas();              // Mostra reservas ativas para o usuário
+}
 
-    do {
-        printf("\nDigite o ID da reserva alvo (ou 0 para sair): ");
-        scanf("%d", &id_reserva_alvo);     // Lê o ID desejado
+void calendario_limpar_faixa(int indice_quarto, long checkin, long checkout) { // Desliga os bits das noites [checkin, checkout)
+    Hotel *hotel = hotel_atual;
+    long inicio = checkin - hotel->calendario_inicio;
+    long fim = checkout - hotel->calendario_inicio;
+    if (inicio < 0) inicio = 0;
+    if (fim > HORIZONTE_CALENDARIO) fim = HORIZONTE_CALENDARIO;
+    unsigned long long mascara = ~(1ULL << (indice_quarto & 63));
+    unsigned long long *coluna = hotel->calendario_ocupacao + (indice_quarto >> 6);
+    for (long noite = inicio; noite < fim; noite++) {
+        coluna[noite * hotel->palavras_por_noite] &= mascara;
+    }
+}
 
-        if (id_reserva_alvo == 0) {        // Se usuário cancelar a operação
-            printf("Genciamento cancelado\n");
-            return;
+void calendario_reconstruir() {           // Refaz todos os bitmaps a partir das agendas (janela e largura atuais)
+    Hotel *hotel = hotel_atual;
+    int largura = (hotel->capacidade_quartos + 63) / 64; // Largura pela capacidade: cresce junto, geometricamente
+    if (largura == 0) largura = 1;
+    if (largura != hotel->palavras_por_noite || hotel->calendario_ocupacao == NULL) {
+        free(hotel->calendario_ocupacao);
+        free(hotel->calendario_acumulado);
+        hotel->calendario_ocupacao = (unsigned long long *)malloc((size_t)HORIZONTE_CALENDARIO * largura * sizeof(unsigned long long));
+        hotel->calendario_acumulado = (unsigned long long *)malloc(largura * sizeof(unsigned long long));
+        if (hotel->calendario_ocupacao == NULL || hotel->calendario_acumulado == NULL) {
+            fprintf(stderr, "Erro fatal: Nao foi possivel alocar memoria para o calendario!\n");
+            exit(1);
         }
-        encontrado = 0;                    // Reinicia flag de encontrado
-
-        for (int i = 0; i < contador_reservas; i++) { // Percorre reservas cadastradas
-            if (reservas_hotel[i].id_reserva == id_reserva_alvo && reservas_hotel[i].status_reserva == ATIVA) { // Encontra reserva ativa
-                encontrado = 1;
-
-                printf("\nReserva %d encontrada. Escolha a acao:\n", id_reserva_alvo); // Mostra opções
-                printf("1 - CANCELAR reserva (Status: CANCELADA)\n");
-                printf("2 - CONCLUIR reserva (Status: CONCLUIDA / Check-out)\n");
-                do{
-                    scanf("%d", &sub_opcao); // Lê escolha do usuário
-                    if (sub_opcao == 1) {
-                        novo_status_reserva = CANCELADA; // Define novo status como CANCELADA
-                        printf("Reserva %d CANCELADA.\n", id_reserva_alvo);
-                    }else if (sub_opcao == 2) {
-                        novo_status_reserva = CONCLUIDA; // Define novo status como CONCLUIDA
-                        printf("Reserva %d CONCLUIDA (Check-out).\n", id_reserva_alvo);
-                    } else {
-                        printf("Opcao invalida. Digite novamente\n");
-                    }
-                }while(sub_opcao != 1 && sub_opcao != 2);
-adicionar_reserva_ao_historico(reservas_hotel[i].id_hospede, reservas_hotel[i].id_reserva); // Move reserva para histórico do hóspede
-                reservas_hotel[i].status_reserva = novo_status_reserva; // Atualiza status da reserva
-                quarto_associado = reservas_hotel[i].numero_quarto; // Recupera quarto associado
-                atualizar_status_quarto(quarto_associado, LIVRE); // Libera o quarto
-                printf("Quarto %d agora esta LIVRE.\n", quarto_associado); // Informa liberação
-                return;                         // Sai após gerenciar a reserva
-            }
+        hotel->palavras_por_noite = largura;
+    }
+    memset(hotel->calendario_ocupacao, 0, (size_t)HORIZONTE_CALENDARIO * largura * sizeof(unsigned long long));
+    long fim_janela = hotel->calendario_inicio + HORIZONTE_CALENDARIO;
+    for (int q = 0; q < hotel->contador_quartos; q++) {
+        if (hotel->quartos_hotel[q].status != LIVRE) { // Fora de operação: a janela inteira conta como ocupada
+            calendario_marcar_faixa(q, hotel->calendario_inicio, fim_janela);
+            continue;
         }
-        if (encontrado == 0) {              // Se não encontrou reserva válida
-            printf("ERRO: ID de reserva invalido ou reserva inativa. Tente novamente.\n");
+        AgendaQuarto *agenda = &hotel->agendas_quartos[q];
+        for (int k = 0; k < agenda->num_intervalos && agenda->intervalos[k].checkin < fim_janela; k++) {
+            if (agenda->intervalos[k].checkout > hotel->calendario_inicio) {
+                calendario_marcar_faixa(q, agenda->intervalos[k].checkin, agenda->intervalos[k].checkout);
+            }
         }
-    } while (encontrado == 0);             // Repete até encontrar ou sair
+    }
+    hotel->calendario_valido = 1;
 }
 
+int calendario_atualizado() {             // 1 se o calendário pode responder consultas sem ser refeito
+    Hotel *hotel = hotel_atual;
+    return hotel->calendario_valido && hotel->contador_quartos <= hotel->palavras_por_noite * 64 &&
+           dia_hoje() - DIAS_PASSADOS_CALENDARIO - hotel->calendario_inicio < 7; // A janela só rola depois de uma semana de atraso
+}
 
+void calendario_preparar() {              // Garante calendário válido, largo o bastante e com a janela atualizada
+    Hotel *hotel = hotel_atual;
+    long inicio_desejado = dia_hoje() - DIAS_PASSADOS_CALENDARIO;
+    if (calendario_atualizado()) {
+        return;
+    }
+    if (!hotel->calendario_valido || inicio_desejado - hotel->calendario_inicio >= 7) {
+        hotel->calendario_inicio = inicio_desejado;
+    }
+    calendario_reconstruir();
+}
 
+void calendario_reserva_criada(int indice_quarto, long checkin, long checkout) { // Mantém os bits após uma reserva
+    Hotel *hotel = hotel_atual;
+    travar_se_concorrente(&trava_calendario); // Quartos vizinhos dividem a mesma palavra
+    if (indice_quarto >= hotel->palavras_por_noite * 64) { // Quarto além da largura atual: refaz com mais palavras
+        hotel->calendario_valido = 0;
+    } else if (hotel->calendario_valido) { // Inválido: será refeito por inteiro na próxima consulta
+        calendario_marcar_faixa(indice_quarto, checkin, checkout);
+    }
+    destravar_se_concorrente(&trava_calendario);
+}
+
+void calendario_reserva_removida(int indice_quarto, long checkin, long checkout) { // Mantém os bits após um cancelamento
+    Hotel *hotel = hotel_atual;
+    travar_se_concorrente(&trava_calendario);
+    if (!hotel->calendario_valido || indice_quarto >= hotel->palavras_por_noite * 64) {
+        destravar_se_concorrente(&trava_calendario);
+        return;
+    }
+    calendario_limpar_faixa(indice_quarto, checkin, checkout);
+    // Intervalos que sobrepõem o removido (reservas concluídas podem se sobrepor) voltam a marcar suas noites
+    AgendaQuarto *agenda = &hotel->agendas_quartos[indice_quarto];
+    int p = agenda_contar_antes(agenda, checkout);
+    for (int k = 0; k < p; k++) {
+        if (agenda->intervalos[k].checkout > checkin) {
+            calendario_marcar_faixa(indice_quarto, agenda->intervalos[k].checkin, agenda->intervalos[k].checkout);
+        }
+    }
+    destravar_se_concorrente(&trava_calendario);
+}
+
+int calendario_cobre(long checkin, long checkout) { // 1 se o período inteiro está dentro da janela
+    Hotel *hotel = hotel_atual;
+    return checkin >= hotel->calendario_inicio && checkout <= hotel->calendario_inicio + HORIZONTE_CALENDARIO && checkin < checkout;
+}
+
+typedef struct {                        // Contexto do OR paralelo das linhas do calendário
+    long primeira_noite;                 // Noite inicial (relativa à janela)
+    long noites;                         // Quantidade de noites do período
+} ConsultaCalendario;
+
+void calendario_or_palavras(int inicio, int fim, int bloco, void *contexto) { // OR das noites para as palavras [inicio, fim)
+    Hotel *hotel = hotel_atual;
+    const ConsultaCalendario *consulta = (const ConsultaCalendario *)contexto;
+    unsigned long long *acumulado = hotel->calendario_acumulado;
+    const unsigned long long *linha = hotel->calendario_ocupacao + consulta->primeira_noite * hotel->palavras_por_noite;
+    (void)bloco;
+    memcpy(acumulado + inicio, linha + inicio, (fim - inicio) * sizeof(unsigned long long));
+    for (long noite = 1; noite < consulta->noites; noite++) { // OR das linhas: laço simples, vetorizado pelo compilador
+        linha += hotel->palavras_por_noite;
+        for (int w = inicio; w < fim; w++) {
+            acumulado[w] |= linha[w];
+        }
+    }
+}
+
+int calendario_coletar_livres(long checkin, long checkout, int *indices) { // Quartos livres no período (exige calendario_cobre)
+    Hotel *hotel = hotel_atual;
+    int largura = (hotel->contador_quartos + 63) / 64; // Só as palavras que têm quartos cadastrados
+    unsigned long long *acumulado = hotel->calendario_acumulado;
+    ConsultaCalendario consulta = {checkin - hotel->calendario_inicio, checkout - checkin};
+    // Faixas de palavras disjuntas por bloco: propriedades grandes dividem o OR entre as threads
+    executar_paralelo(largura, planejar_blocos(largura, MIN_PALAVRAS_POR_BLOCO), calendario_or_palavras, &consulta);
+    int quantidade = 0;
+    for (int w = 0; w < largura; w++) {   // Bits desligados = quartos livres, em ordem de índice
+        unsigned long long livres = ~acumulado[w];
+        if (w == largura - 1 && (hotel->contador_quartos & 63) != 0) {
+            livres &= (1ULL << (hotel->contador_quartos & 63)) - 1; // Ignora posições sem quarto na última palavra
+        }
+        while (livres != 0) {
+#ifdef __GNUC__
+            int b = __builtin_ctzll(livres); // Posição do bit ligado mais baixo
+#else
+            int b = 0;
+            while (((livres >> b) & 1ULL) == 0) b++;
+#endif
+            indices[quantidade++] = w * 64 + b;
+            livres &= livres - 1;          // Desliga o bit já visitado
+        }
+    }
+    return quantidade;
+}
+
+int comparar_intervalos(const void *a, const void *b) { // Ordena intervalos por checkin (qsort)
+    long x = ((const IntervaloReserva *)a)->checkin;
+    long y = ((const IntervaloReserva *)b)->checkin;
+    return (x > y) - (x < y);
+}
+
+void agenda_ordenar(int indice_quarto) {   // Ordena a agenda inteira e refaz os máximos (carga em lote)
+    AgendaQuarto *agenda = &hotel_atual->agendas_quartos[indice_quarto];
+    if (agenda->num_intervalos > 1) {
+        qsort(agenda->intervalos, agenda->num_intervalos, sizeof(IntervaloReserva), comparar_intervalos);
+    }
+    agenda_recalcular_maximos(agenda, 0);
+}
+
+//INDICE DE QUARTOS POR NUMERO
+unsigned long hash_numero_quarto(int numero) { // Espalha o número do quarto (hash multiplicativo)
+    return (unsigned long)((unsigned int)numero * 2654435761U);
+}
+
+int *indice_quartos_hash_posicao(int numero) { // Posição do número na tabela hash (ocupada por ele ou vazia)
+    Hotel *hotel = hotel_atual;
+    unsigned long mascara = (unsigned long)hotel->capacidade_indice_quartos_hash - 1;
+    unsigned long pos = hash_numero_quarto(numero) & mascara;
+    while (hotel->indice_quartos_hash[pos] != -1 && hotel->quartos_hotel[hotel->indice_quartos_hash[pos]].numero != numero) {
+        pos = (pos + 1) & mascara;         // Sondagem linear
+    }
+    return &hotel->indice_quartos_hash[pos];
+}
+
+void indice_quartos_adicionar(int indice_quarto) { // Registra no índice um quarto recém-cadastrado
+    Hotel *hotel = hotel_atual;
+    int numero = hotel->quartos_hotel[indice_quarto].numero;
+
+    if (numero >= 0 && numero < LIMITE_INDICE_DIRETO) { // Numeração densa: tabela de endereçamento direto
+        if (numero >= hotel->tamanho_indice_direto) { // Cresce (dobrando) até cobrir o número
+            int novo_tamanho = (hotel->tamanho_indice_direto == 0) ? 1024 : hotel->tamanho_indice_direto;
+            while (novo_tamanho <= numero) novo_tamanho *= 2;
+            if (novo_tamanho > LIMITE_INDICE_DIRETO) novo_tamanho = LIMITE_INDICE_DIRETO;
+            int *temp = (int *)realloc(hotel->indice_quartos_direto, novo_tamanho * sizeof(int));
+            if (temp == NULL) {            // Verifica falha de alocação
+                fprintf(stderr, "Erro fatal: Nao foi possivel alocar memoria para o indice de quartos!\n");
+                exit(1);
+            }
+            memset(temp + hotel->tamanho_indice_direto, -1, (novo_tamanho - hotel->tamanho_indice_direto) * sizeof(int)); // Novas posições vazias
+            hotel->indice_quartos_direto = temp;
+            hotel->tamanho_indice_direto = novo_tamanho;
+        }
+        hotel->indice_quartos_direto[numero] = indice_quarto;
+        return;
+    }
+
+    if ((hotel->ocupacao_indice_quartos_hash + 1) * 2 > hotel->capacidade_indice_quartos_hash) { // Numeração esparsa: hash com ocupação <= 50%
+        int capacidade_antiga = hotel->capacidade_indice_quartos_hash;
+        int *antiga = hotel->indice_quartos_hash;
+        hotel->capacidade_indice_quartos_hash = (capacidade_antiga == 0) ? 64 : capacidade_antiga * 2;
+        hotel->indice_quartos_hash = (int *)malloc(hotel->capacidade_indice_quartos_hash * sizeof(int));
+        if (hotel->indice_quartos_hash == NULL) { // Verifica falha de alocação
+            fprintf(stderr, "Erro fatal: Nao foi possivel alocar memoria para o indice de quartos!\n");
+            exit(1);
+        }
+        memset(hotel->indice_quartos_hash, -1, hotel->capacidade_indice_quartos_hash * sizeof(int));
+        for (int i = 0; i < capacidade_antiga; i++) { // Reinsere o conteúdo da tabela antiga
+            if (antiga[i] != -1) *indice_quartos_hash_posicao(hotel->quartos_hotel[antiga[i]].numero) = antiga[i];
+        }
+        free(antiga);
+    }
+    *indice_quartos_hash_posicao(numero) = indice_quarto;
+    hotel->ocupacao_indice_quartos_hash++;
+}
+
+int buscar_quarto_por_numero(int num_procurado) { // Retorna índice do quarto dado o número, em O(1)
+    Hotel *hotel = hotel_atual;
+    MEDIR_INICIO(MEDIDA_BUSCAR_QUARTO);
+    int indice = -1;
+    long sondagens = 1;                    // Posições lidas no índice
+    if (num_procurado >= 0 && num_procurado < LIMITE_INDICE_DIRETO) { // Faixa da tabela direta
+        indice = (num_procurado < hotel->tamanho_indice_direto) ? hotel->indice_quartos_direto[num_procurado] : -1;
+    } else if (hotel->capacidade_indice_quartos_hash != 0) { // Há quartos com numeração esparsa
+        int *posicao = indice_quartos_hash_posicao(num_procurado);
+        unsigned long mascara = (unsigned long)hotel->capacidade_indice_quartos_hash - 1;
+        indice = *posicao;                 // -1 se a posição encontrada estiver vazia
+        sondagens += ((unsigned long)(posicao - hotel->indice_quartos_hash) - hash_numero_quarto(num_procurado)) & mascara; // Distância sondada
+    }
+    MEDIR_FIM(MEDIDA_BUSCAR_QUARTO, sondagens);
+    return indice;
+}
+
+int verificar_quarto_existe(int numero_procurado) { // Verifica se já existe quarto com certo número
+    return buscar_quarto_por_numero(numero_procurado) != -1; // Retorna 1 se existir, 0 caso contrário
+}
+
+//ANALISE DE OCUPACAO E RECEITA (AGREGADOS INCREMENTAIS)
+// Cada tipo de quarto tem uma série de contadores por noite e outra por mês. Criar uma reserva soma suas
+// noites e a receita de cada noite nas séries do tipo do quarto; cancelar subtrai; concluir não muda nada.
+// A receita fica em centavos: cada noite recebe valor / noites e as primeiras valor % noites recebem um
+// centavo a mais, então cancelar subtrai exatamente o que a criação somou.
+// Relatórios leem só os períodos pedidos (O(dias x tipos)), sem percorrer as reservas.
+
+int buscar_tipo_quarto(const char *tipo) { // ID do tipo com esse nome, ou -1 (poucos tipos: busca linear)
+    Hotel *hotel = hotel_atual;
+    for (int t = 0; t < hotel->contador_tipos; t++) {
+        if (strcmp(hotel->tipos_quarto[t], tipo) == 0) return t;
+    }
+    return -1;
+}
+
+int registrar_tipo_quarto(const char *tipo) { // ID do tipo, cadastrando-o se ainda não existir (acesso exclusivo)
+    Hotel *hotel = hotel_atual;
+    int id_tipo = buscar_tipo_quarto(tipo);
+    if (id_tipo != -1) return id_tipo;
+    int capacidade_anterior = hotel->capacidade_tipos;
+    hotel->tipos_quarto = (char (*)[TAM_TIPO])crescer_vetor(hotel->tipos_quarto, &hotel->capacidade_tipos, hotel->contador_tipos + 1,
+                                                            TAM_TIPO, "tipo de quarto");
+    if (hotel->capacidade_tipos != capacidade_anterior) { // Contadores e séries acompanham o dicionário
+        int capacidade = capacidade_anterior;
+        hotel->quartos_por_tipo = (int *)crescer_vetor(hotel->quartos_por_tipo, &capacidade, hotel->capacidade_tipos, sizeof(int),
+                                                       "tipo de quarto");
+        capacidade = capacidade_anterior;
+        hotel->series_diarias = (SerieAnalise *)crescer_vetor(hotel->series_diarias, &capacidade, hotel->capacidade_tipos,
+                                                              sizeof(SerieAnalise), "serie de analise");
+        capacidade = capacidade_anterior;
+        hotel->series_mensais = (SerieAnalise *)crescer_vetor(hotel->series_mensais, &capacidade, hotel->capacidade_tipos,
+                                                              sizeof(SerieAnalise), "serie de analise");
+        int novos = hotel->capacidade_tipos - capacidade_anterior;
+        memset(&hotel->quartos_por_tipo[capacidade_anterior], 0, novos * sizeof(int)); // Novos tipos começam zerados
+        memset(&hotel->series_diarias[capacidade_anterior], 0, novos * sizeof(SerieAnalise));
+        memset(&hotel->series_mensais[capacidade_anterior], 0, novos * sizeof(SerieAnalise));
+    }
+    strcpy(hotel->tipos_quarto[hotel->contador_tipos], tipo);
+    return hotel->contador_tipos++;
+}
+
+void analise_adicionar_quarto(int indice_quarto) { // Classifica um quarto recém-cadastrado pelo seu tipo
+    Hotel *hotel = hotel_atual;
+    int id_tipo = registrar_tipo_quarto(hotel->quartos_hotel[indice_quarto].tipo);
+    hotel->tipos_dos_quartos[indice_quarto] = id_tipo;
+    hotel->quartos_por_tipo[id_tipo]++;
+}
+
+long mes_absoluto(long dia) {             // Mês do dia absoluto, contado como ano * 12 + mês - 1
+    int d, m, a;
+    dias_para_data(dia, &d, &m, &a);
+    return a * 12L + m - 1;
+}
+
+long inicio_do_mes(long mes) {            // Dia absoluto do primeiro dia do mês absoluto 'mes'
+    return contar_dias(1, (int)(mes % 12) + 1, (int)(mes / 12));
+}
+
+void serie_cobrir(SerieAnalise *serie, long inicio, long fim) { // Garante contadores para os períodos [inicio, fim)
+    long atual_fim = serie->primeiro + serie->quantidade;
+    if (serie->quantidade > 0 && inicio >= serie->primeiro && fim <= atual_fim) return;
+    long novo_inicio = inicio, novo_fim = fim;
+    if (serie->quantidade > 0) {           // Estende só o lado que falta, ao menos dobrando (custo amortizado constante)
+        novo_inicio = serie->primeiro;
+        novo_fim = atual_fim;
+        if (inicio < novo_inicio) novo_inicio = (inicio < novo_inicio - serie->quantidade) ? inicio : novo_inicio - serie->quantidade;
+        if (fim > novo_fim) novo_fim = (fim > novo_fim + serie->quantidade) ? fim : novo_fim + serie->quantidade;
+    }
+    int quantidade = (int)(novo_fim - novo_inicio);
+    int *noites = (int *)calloc(quantidade, sizeof(int));
+    long long *receita = (long long *)calloc(quantidade, sizeof(long long));
+    if (noites == NULL || receita == NULL) { // Verifica falha de alocação
+        fprintf(stderr, "Erro fatal: Nao foi possivel alocar memoria para a analise de ocupacao!\n");
+        exit(1);
+    }
+    if (serie->quantidade > 0) {           // Contadores antigos vão para a nova posição do seu período
+        memcpy(noites + (serie->primeiro - novo_inicio), serie->noites, serie->quantidade * sizeof(int));
+        memcpy(receita + (serie->primeiro - novo_inicio), serie->receita, serie->quantidade * sizeof(long long));
+    }
+    free(serie->noites);
+    free(serie->receita);
+    serie->noites = noites;
+    serie->receita = receita;
+    serie->primeiro = novo_inicio;
+    serie->quantidade = quantidade;
+}
+
+void serie_somar(SerieAnalise *serie, long periodo, int noites, long long receita) { // Ajusta um período já coberto
+    long k = periodo - serie->primeiro;
+    serie->noites[k] += noites;
+    serie->receita[k] += receita;
+}
+
+long long receita_noites(long long valor_centavos, long total_noites, long primeira, long fim) { // Centavos das noites [primeira, fim) da estadia
+    long long base = valor_centavos / total_noites;
+    long resto = (long)(valor_centavos % total_noites); // As primeiras 'resto' noites levam um centavo a mais
+    long com_resto = ((fim < resto) ? fim : resto) - primeira;
+    return base * (fim - primeira) + (com_resto > 0 ? com_resto : 0);
+}
+
+void analise_registrar(int indice_quarto, long checkin, long checkout, long long valor_centavos, int sinal) { // Soma (+1) ou subtrai (-1) uma reserva
+    Hotel *hotel = hotel_atual;
+    SerieAnalise *dias = &hotel->series_diarias[hotel->tipos_dos_quartos[indice_quarto]];
+    SerieAnalise *meses = &hotel->series_mensais[hotel->tipos_dos_quartos[indice_quarto]];
+    long noites = checkout - checkin;
+    travar_se_concorrente(&trava_analise);
+    serie_cobrir(dias, checkin, checkout);
+    for (long dia = checkin; dia < checkout; dia++) {
+        serie_somar(dias, dia, sinal, sinal * receita_noites(valor_centavos, noites, dia - checkin, dia - checkin + 1));
+    }
+    serie_cobrir(meses, mes_absoluto(checkin), mes_absoluto(checkout - 1) + 1);
+    for (long dia = checkin; dia < checkout; ) { // Um passo por mês tocado pela estadia
+        long mes = mes_absoluto(dia);
+        long fim = inicio_do_mes(mes + 1);
+        if (fim > checkout) fim = checkout;
+        serie_somar(meses, mes, sinal * (int)(fim - dia), sinal * receita_noites(valor_centavos, noites, dia - checkin, fim - checkin));
+        dia = fim;
+    }
+    destravar_se_concorrente(&trava_analise);
+}
+
+void serie_acumular(const SerieAnalise *serie, long inicio, long fim, long long *noites, long long *receita) { // Soma [inicio, fim)
+    if (inicio < serie->primeiro) inicio = serie->primeiro; // Períodos fora da série não têm vendas
+    if (fim > serie->primeiro + serie->quantidade) fim = serie->primeiro + serie->quantidade;
+    for (long p = inicio; p < fim; p++) {
+        *noites += serie->noites[p - serie->primeiro];
+        *receita += serie->receita[p - serie->primeiro];
+    }
+}
+
+void escrever_linha_analise(BufferSaida *saida, const char *rotulo, int quartos, long dias, long long noites, long long centavos) {
+    double oferta = (double)quartos * dias; // Noites disponíveis no período
+    double receita = centavos / 100.0;     // Só a exibição sai dos centavos
+    saida_printf(saida, "%-28s | %7d | %10lld | %7.2f%% | R$%13.2f | R$%9.2f | R$%9.2f\n", rotulo, quartos, noites,
+                 oferta > 0 ? 100.0 * noites / oferta : 0.0,  // Taxa de ocupação
+                 receita,
+                 noites > 0 ? receita / noites : 0.0,         // Diária média (ADR)
+                 oferta > 0 ? receita / oferta : 0.0);        // Receita por quarto disponível (RevPAR)
+}
+
+void escrever_cabecalho_analise(BufferSaida *saida) {
+    saida_printf(saida, "%-28s | %7s | %10s | %8s | %15s | %11s | %11s\n",
+                 "Tipo", "Quartos", "Noites", "Ocupacao", "Receita", "ADR", "RevPAR");
+}
+
+void escrever_relatorio_periodo(BufferSaida *saida, long inicio, long fim) { // Ocupação e receita por tipo nas noites [inicio, fim)
+    Hotel *hotel = hotel_atual;
+    char data_in[TAM_DATA], data_out[TAM_DATA];
+    formatar_data(inicio, data_in);
+    formatar_data(fim, data_out);
+    saida_printf(saida, "\n--- OCUPACAO E RECEITA DE %s A %s (%ld noites) ---\n", data_in, data_out, fim - inicio);
+    if (hotel->contador_tipos == 0) {
+        saida_printf(saida, "Nenhum quarto cadastrado.\n");
+        return;
+    }
+    escrever_cabecalho_analise(saida);
+    long long noites_total = 0;
+    long long receita_total = 0;
+    travar_se_concorrente(&trava_analise);
+    for (int t = 0; t < hotel->contador_tipos; t++) {
+        long long noites = 0;
+        long long receita = 0;
+        serie_acumular(&hotel->series_diarias[t], inicio, fim, &noites, &receita);
+        escrever_linha_analise(saida, hotel->tipos_quarto[t], hotel->quartos_por_tipo[t], fim - inicio, noites, receita);
+        noites_total += noites;
+        receita_total += receita;
+    }
+    destravar_se_concorrente(&trava_analise);
+    escrever_linha_analise(saida, "TOTAL", hotel->contador_quartos, fim - inicio, noites_total, receita_total);
+}
+
+void escrever_relatorio_mensal(BufferSaida *saida, int ano) { // Ocupação e receita por tipo em cada mês do ano
+    Hotel *hotel = hotel_atual;
+    saida_printf(saida, "\n--- OCUPACAO E RECEITA MENSAL DE %04d ---\n", ano);
+    if (hotel->contador_tipos == 0) {
+        saida_printf(saida, "Nenhum quarto cadastrado.\n");
+        return;
+    }
+    escrever_cabecalho_analise(saida);
+    char rotulo[TAM_TIPO + 16];
+    travar_se_concorrente(&trava_analise);
+    for (long mes = ano * 12L; mes < ano * 12L + 12; mes++) {
+        long dias = inicio_do_mes(mes + 1) - inicio_do_mes(mes);
+        long long noites_total = 0;
+        long long receita_total = 0;
+        for (int t = 0; t < hotel->contador_tipos; t++) {
+            long long noites = 0;
+            long long receita = 0;
+            serie_acumular(&hotel->series_mensais[t], mes, mes + 1, &noites, &receita);
+            snprintf(rotulo, sizeof(rotulo), "%02ld/%04d %s", mes % 12 + 1, ano, hotel->tipos_quarto[t]);
+            escrever_linha_analise(saida, rotulo, hotel->quartos_por_tipo[t], dias, noites, receita);
+            noites_total += noites;
+            receita_total += receita;
+        }
+        snprintf(rotulo, sizeof(rotulo), "%02ld/%04d TOTAL", mes % 12 + 1, ano);
+        escrever_linha_analise(saida, rotulo, hotel->contador_quartos, dias, noites_total, receita_total);
+    }
+    destravar_se_concorrente(&trava_analise);
+}
+
+void analise_liberar() {                  // Libera dicionário de tipos e séries
+    Hotel *hotel = hotel_atual;
+    for (int t = 0; t < hotel->contador_tipos; t++) {
+        free(hotel->series_diarias[t].noites);
+        free(hotel->series_diarias[t].receita);
+        free(hotel->series_mensais[t].noites);
+        free(hotel->series_mensais[t].receita);
+    }
+    free(hotel->series_diarias);
+    free(hotel->series_mensais);
+    free(hotel->quartos_por_tipo);
+    free(hotel->tipos_quarto);
+}
+
+//TARIFAS (REGRAS POR NOITE, VALORES EM CENTAVOS)
+// A diária de uma noite é o preço do quarto ajustado pela regra mais recente que cobre a noite (tipo do
+// quarto, período e dia da semana); sem regra, vale o preço cheio. Valores são inteiros em centavos:
+// cada noite é arredondada ao centavo uma vez e a soma é exata.
+
+long long centavos_de_preco(float preco) { // Preço do cadastro em centavos (arredondado ao mais próximo)
+    return (long long)(preco * 100.0 + 0.5);
+}
+
+long long diaria_com_percentual(long long base_centavos, int percentual) { // Diária ajustada, arredondada ao centavo
+    return (base_centavos * percentual + 50) / 100;
+}
+
+int dia_da_semana(long dia) {             // 0 = domingo ... 6 = sábado (01/01/1970 foi uma quinta-feira)
+    return (int)(((dia % 7) + 7 + 4) % 7);
+}
+
+int percentual_da_noite(const char *tipo, long dia) { // Percentual da regra mais recente que cobre a noite, ou 100
+    Hotel *hotel = hotel_atual;
+    for (int r = hotel->contador_regras - 1; r >= 0; r--) {
+        const RegraTarifa *regra = &hotel->regras_tarifa[r];
+        if (dia >= regra->inicio && dia < regra->fim && (regra->dias_semana >> dia_da_semana(dia) & 1) &&
+            (strcmp(regra->tipo, "*") == 0 || strcmp(regra->tipo, tipo) == 0)) {
+            return regra->percentual;
+        }
+    }
+    return 100;
+}
+
+long long valor_estadia_centavos(int indice_quarto, long checkin, long checkout) { // Soma das diárias de [checkin, checkout)
+    Hotel *hotel = hotel_atual;
+    long long base = centavos_de_preco(hotel->quartos_hotel[indice_quarto].preco_diaria);
+    if (hotel->contador_regras == 0) { // Sem regras: todas as noites pelo preço cheio
+        return base * (checkout - checkin);
+    }
+    long long total = 0;
+    for (long dia = checkin; dia < checkout; dia++) {
+        total += diaria_com_percentual(base, percentual_da_noite(hotel->quartos_hotel[indice_quarto].tipo, dia));
+    }
+    return total;
+}
+
+int inserir_regra_tarifa(const char *tipo, long inicio, long fim, int dias_semana, int percentual) { // Núcleo do cadastro de regra
+    Hotel *hotel = hotel_atual;
+    if (inicio == DATA_INVALIDA || fim == DATA_INVALIDA || fim <= inicio) { // Período vazio ou mal formado
+        return ERRO_DATAS_INVALIDAS;
+    }
+    if (strlen(tipo) >= TAM_TIPO || dias_semana <= 0 || dias_semana > TODOS_OS_DIAS ||
+        percentual < 0 || percentual > MAX_PERCENTUAL_TARIFA) {
+        return ERRO_PARAMETRO_INVALIDO;   // Tipo longo demais, nenhum dia da semana ou percentual fora da faixa
+    }
+    hotel->regras_tarifa = (RegraTarifa *)crescer_vetor(hotel->regras_tarifa, &hotel->capacidade_regras, hotel->contador_regras + 1,
+                                                        sizeof(RegraTarifa), "regra de tarifa");
+    RegraTarifa *regra = &hotel->regras_tarifa[hotel->contador_regras];
+    memset(regra, 0, sizeof(RegraTarifa)); // Zera o preenchimento (snapshot e journal gravam o registro inteiro)
+    strcpy(regra->tipo, tipo);
+    regra->inicio = inicio;
+    regra->fim = fim;
+    regra->dias_semana = dias_semana;
+    regra->percentual = percentual;
+    hotel->contador_regras++;
+    journal_registrar(JOURNAL_TARIFA, regra, sizeof(RegraTarifa)); // Registra a alteração no journal
+    return OPERACAO_OK;
+}
+
+//INDICE DE QUARTOS POR TIPO E PRECO
+// Para cada ID de tipo do dicionário, os quartos em ordem de (diária em centavos, número). Cadastros só
+// acrescentam no fim; a lista é reordenada na primeira consulta depois de um cadastro fora de ordem.
+// As regras de tarifa valem por tipo e noite, então dentro de um tipo a ordem da diária é também a ordem
+// do valor da estadia: a busca dos k mais baratos percorre a lista e para no k-ésimo quarto livre.
+
+int comparar_quartos_preco(const void *a, const void *b) { // Mais barato primeiro; empate pelo número (qsort)
+    Hotel *hotel = hotel_atual;
+    const Quarto *x = &hotel->quartos_hotel[*(const int *)a], *y = &hotel->quartos_hotel[*(const int *)b];
+    long long preco_x = centavos_de_preco(x->preco_diaria), preco_y = centavos_de_preco(y->preco_diaria);
+    if (preco_x != preco_y) return (preco_x < preco_y) ? -1 : 1;
+    return (x->numero > y->numero) - (x->numero < y->numero);
+}
+
+void indice_preco_adicionar(int indice_quarto) { // Acrescenta um quarto já classificado ao índice do seu tipo
+    Hotel *hotel = hotel_atual;
+    int id_tipo = hotel->tipos_dos_quartos[indice_quarto];
+    if (id_tipo >= hotel->capacidade_indices_preco) { // Tipo novo: índices vazios até ele
+        int capacidade_anterior = hotel->capacidade_indices_preco;
+        hotel->indices_preco = (IndicePrecoTipo *)crescer_vetor(hotel->indices_preco, &hotel->capacidade_indices_preco, id_tipo + 1,
+                                                                sizeof(IndicePrecoTipo), "indice de precos");
+        memset(&hotel->indices_preco[capacidade_anterior], 0,
+               (hotel->capacidade_indices_preco - capacidade_anterior) * sizeof(IndicePrecoTipo));
+    }
+    IndicePrecoTipo *indice = &hotel->indices_preco[id_tipo];
+    if (indice->quantidade == 0) indice->ordenado = 1;
+    if (indice->ordenado && indice->quantidade > 0 &&
+        comparar_quartos_preco(&indice->indices[indice->quantidade - 1], &indice_quarto) > 0) {
+        indice->ordenado = 0;              // Fora de ordem: reordena na próxima consulta
+    }
+    indice->indices = (int *)anexar_registros(indice->indices, &indice->quantidade, &indice->capacidade,
+                                              &indice_quarto, 1, sizeof(int), "indice de precos");
+}
+
+int buscar_mais_baratos(int id_tipo, long dia_in, long dia_out, int k, Oferta *ofertas) {
+    Hotel *hotel = hotel_atual;
+    // Até k quartos do tipo livres no período, do mais barato ao mais caro; -1 se a lista precisa ser
+    // reordenada e não há acesso exclusivo (servidor repete com a trava exclusiva)
+    MEDIR_INICIO(MEDIDA_MAIS_BARATOS);
+    int encontrados = 0, examinados = 0;
+    if (id_tipo >= 0 && id_tipo < hotel->capacidade_indices_preco) {
+        IndicePrecoTipo *indice = &hotel->indices_preco[id_tipo];
+        if (!indice->ordenado) {
+            if (!acesso_exclusivo) {
+                MEDIR_FIM(MEDIDA_MAIS_BARATOS, 0);
+                return -1;
+            }
+            qsort(indice->indices, indice->quantidade, sizeof(int), comparar_quartos_preco);
+            indice->ordenado = 1;
+        }
+        for (; examinados < indice->quantidade && encontrados < k; examinados++) { // Para no k-ésimo livre
+            int i = indice->indices[examinados];
+            travar_se_concorrente(&hotel->travas_quartos[i]); // A agenda do quarto muda sob a trava dele
+            int livre = quarto_livre_periodo(i, dia_in, dia_out);
+            destravar_se_concorrente(&hotel->travas_quartos[i]);
+            if (livre) ofertas[encontrados++].indice_quarto = i;
+        }
+    }
+    for (int n = 0; n < encontrados; n++) { // Valor da estadia com as regras de tarifa
+        ofertas[n].total_centavos = valor_estadia_centavos(ofertas[n].indice_quarto, dia_in, dia_out);
+    }
+    MEDIR_FIM(MEDIDA_MAIS_BARATOS, examinados); // Quartos percorridos até o k-ésimo livre
+    return encontrados;
+}
+
+void indice_preco_liberar() {              // Libera as listas de cada tipo
+    Hotel *hotel = hotel_atual;
+    for (int t = 0; t < hotel->capacidade_indices_preco; t++) {
+        free(hotel->indices_preco[t].indices);
+    }
+    free(hotel->indices_preco);
+}
+
+int inserir_quarto(int numero, const char *tipo, float preco_diaria, int status) { // Núcleo do cadastro de quarto (sem prompts)
+    Hotel *hotel = hotel_atual;
+    if (verificar_quarto_existe(numero)) { // Número precisa ser único
+        return ERRO_QUARTO_EXISTENTE;
+    }
+    if (status < LIVRE || status > MANUTENCAO || strlen(tipo) >= TAM_TIPO || preco_diaria < 0) {
+        return ERRO_PARAMETRO_INVALIDO;   // Status fora da faixa, tipo longo demais ou preço negativo
+    }
+    reservar_quartos(1);                  // Garante espaço para um novo quarto
+
+    Quarto *novo_quarto = &hotel->quartos_hotel[hotel->contador_quartos]; // Ponteiro para o novo elemento
+    novo_quarto->numero = numero;         // Armazena número no novo quarto
+    strcpy(novo_quarto->tipo, tipo);      // Armazena tipo
+    novo_quarto->preco_diaria = preco_diaria; // Armazena preço da diária
+    novo_quarto->status = status;         // Atribui status ao novo quarto
+
+    indice_quartos_adicionar(hotel->contador_quartos); // Indexa o número do novo quarto
+    analise_adicionar_quarto(hotel->contador_quartos); // E o classifica no dicionário de tipos
+    indice_preco_adicionar(hotel->contador_quartos); // E o põe na lista de preços do tipo
+    if (status != LIVRE) {                // Fora de operação: nenhuma noite da janela do calendário fica livre
+        calendario_reserva_criada(hotel->contador_quartos, hotel->calendario_inicio,
+                                  hotel->calendario_inicio + HORIZONTE_CALENDARIO);
+    }
+    hotel->contador_quartos++;      // Incrementa contador global de quartos
+    journal_registrar(JOURNAL_QUARTO, novo_quarto, sizeof(Quarto)); // Registra a alteração no journal
+    return OPERACAO_OK;
+}
+
+void cadastrar_quarto(){                  // Função que cadastra um novo quarto
+    int escolha_status;                   // Variável para guardar status escolhido
+    int numero_digitado;                  // Variável para número do quarto digitado pelo usuário
+    char tipo_digitado[TAM_TIPO];         // Tipo do quarto digitado
+    float preco_digitado;                 // Preço da diária digitado
+
+    printf("\nCadastro de Quarto\n");     // Mensagem inicial
+
+    int numero_repetido;                  // Resultado da consulta ao índice de quartos
+    do {                                  // Loop para garantir número único
+        printf("Digite o numero do quarto: ");
+        scanf("%d", &numero_digitado);    // Lê número do quarto
+        numero_repetido = verificar_quarto_existe(numero_digitado); // Uma única consulta por tentativa
+        if (numero_repetido) {            // Se já existir, avisa
+            printf("ERRO: O quarto %d ja existe. Digite um numero unico.\n", numero_digitado);
+        }
+    } while (numero_repetido);            // Repetir enquanto número existir
+
+    printf("Digite o tipo do quarto (ex: Standard, Deluxe): ");
+    scanf("%s", tipo_digitado);           // Lê tipo (palavra sem espaços)
+
+    printf("Digite o preco da diaria (ex: 150.00): ");
+    scanf("%f", &preco_digitado);         // Lê preço da diária
+
+    do {                                  // Loop para validar entrada do status
+        printf("\nDigite o numero de acordo com o status do quarto:\n");
+        printf("0 - LIVRE\n1 - OCUPADO\n2 - MANUTENCAO\n");
+        printf("Escolha: ");
+        scanf("%d", &escolha_status);     // Lê escolha do usuário
+        if (escolha_status < 0 || escolha_status > 2) { // Verifica validade
+            printf("\nOpcao invalida. Digite novamente.\n");
+        }
+    } while (escolha_status < 0 || escolha_status > 2);
+
+    if (inserir_quarto(numero_digitado, tipo_digitado, preco_digitado, escolha_status) != OPERACAO_OK) { // Grava o quarto
+        printf("\nERRO: Dados do quarto invalidos. Cadastro nao realizado.\n");
+        return;
+    }
+    printf("\nQuarto %d cadastrado com sucesso!\n", numero_digitado); // Confirma cadastro
+}
+
+void listar_quartos_em(long dia) {         // Lista os quartos com o status de cada um na noite 'dia'
+    Hotel *hotel = hotel_atual;
+    printf("\n--- Lista de Quartos Cadastrados (%d no total) ---\n", hotel->contador_quartos); // Cabeçalho
+    if (hotel->contador_quartos == 0) { // Se nenhum quarto cadastrado
+        printf("Nenhum quarto cadastrado ainda.\n");
+        return;
+    }
+
+    printf("Numero | Tipo          | Diaria   | Status\n"); // Títulos das colunas
+    printf("------------------------------------------------\n");
+    for (int i = 0; i < hotel->contador_quartos; i++) { // Percorre cada quarto
+        // Status da data vem da agenda; converte para string legível
+        int status = status_quarto_em(i, dia);
+        const char* status_str = (status == LIVRE) ? "Livre" :
+                                 (status == OCUPADO) ? "Ocupado" :
+                                 (status == MANUTENCAO) ? "Manutencao" : "Desconhecido";
+
+        printf("%-6d | %-13s | R$%-6.2f | %s\n",
+               hotel->quartos_hotel[i].numero, // Exibe número do quarto
+               hotel->quartos_hotel[i].tipo, // Exibe tipo
+               hotel->quartos_hotel[i].preco_diaria, // Exibe preço formatado
+               status_str);                 // Exibe status em texto
+    }
+}
+
+void listar_quartos() {                    // Função para listar todos os quartos cadastrados (status de hoje)
+    listar_quartos_em(dia_hoje());
+}
+
+void reservar_hospedes(int adicionais) { // Garante espaço para mais 'adicionais' hóspedes
+    hospedes_hotel = (Hospede *)crescer_vetor(hospedes_hotel, &capacidade_hospedes, contador_hospedes + adicionais,
+                                              sizeof(Hospede), "hospede");
+    indice_hospedes_id = indice_id_crescer(indice_hospedes_id, &capacidade_indice_hospedes_id, capacidade_hospedes + 1,
+                                           "indice de hospedes"); // IDs sequenciais: cabem na capacidade + 1
+}
+
+int buscar_hospede_por_id(int id_hospede) { // Retorna índice do hóspede pelo ID, em O(1)
+    return indice_id_buscar(indice_hospedes_id, capacidade_indice_hospedes_id, id_hospede);
+}
+
+int indice_hospedes_id_adicionar(int indice_hospede) { // Registra o ID de um hóspede; 0 se o ID já estava em uso
+    int id = hospedes_hotel[indice_hospede].id_hospede;
+    if (id < 0) return 0;
+    indice_hospedes_id = indice_id_crescer(indice_hospedes_id, &capacidade_indice_hospedes_id, id + 1, "indice de hospedes");
+    if (indice_hospedes_id[id] != -1) return 0;
+    indice_hospedes_id[id] = indice_hospede;
+    return 1;
+}
+
+//CODIFICACAO COMPACTA DO HOSPEDE
+// CPF e telefone são validados e guardados como inteiros de 64 bits; o texto só é refeito para exibir,
+// exportar e gravar. Nomes ficam na arena_nomes e os históricos em blocos encadeados no pool_historicos:
+// nenhum hóspede tem alocação própria.
+int codificar_cpf(const char *texto, unsigned long long *cpf) { // 11 dígitos, com '.' e '-' opcionais; 0 se inválido
+    unsigned long long valor = 0;
+    int digitos = 0;
+    for (; *texto != '\0'; texto++) {
+        if (*texto >= '0' && *texto <= '9') {
+            if (++digitos > DIGITOS_CPF) return 0;
+            valor = valor * 10 + (unsigned long long)(*texto - '0');
+        } else if (*texto != '.' && *texto != '-') {
+            return 0;
+        }
+    }
+    *cpf = valor;
+    return digitos == DIGITOS_CPF;
+}
+
+char *texto_cpf(unsigned long long cpf, char *texto) { // Escreve o CPF (só dígitos) em 'texto' [TAM_CPF] e o devolve
+    snprintf(texto, TAM_CPF, "%0*llu", DIGITOS_CPF, cpf);
+    return texto;
+}
+
+int codificar_telefone(const char *texto, unsigned long long *telefone) {
+    // Até MAX_DIGITOS_TELEFONE dígitos; ' ', '(', ')', '-' e '+' são ignorados; 0 se inválido
+    unsigned long long valor = 0, marcador = 1; // marcador = 10^dígitos
+    int digitos = 0;
+    for (; *texto != '\0'; texto++) {
+        if (*texto >= '0' && *texto <= '9') {
+            if (++digitos > MAX_DIGITOS_TELEFONE) return 0;
+            valor = valor * 10 + (unsigned long long)(*texto - '0');
+            marcador *= 10;
+        } else if (strchr(" ()-+", *texto) == NULL) {
+            return 0;
+        }
+    }
+    *telefone = marcador + valor;          // O marcador preserva os zeros à esquerda
+    return digitos > 0;
+}
+
+char *texto_telefone(unsigned long long telefone, char *texto) { // Escreve o telefone em 'texto' [TAM_TELEFONE]
+    unsigned long long marcador = 10;
+    int digitos = 1;
+    while (marcador * 10 <= telefone) {    // telefone = 10^dígitos + número, com número < 10^dígitos
+        marcador *= 10;
+        digitos++;
+    }
+    snprintf(texto, TAM_TELEFONE, "%0*llu", digitos, telefone - marcador);
+    return texto;
+}
+
+const char *nome_hospede(const Hospede *h) { // Nome do hóspede (válido até o próximo cadastro)
+    return arena_nomes + h->nome;
+}
+
+int arena_nomes_adicionar(const char *nome) { // Copia o nome para a arena; retorna a posição dele
+    int posicao = tamanho_arena_nomes;
+    arena_nomes = (char *)anexar_registros(arena_nomes, &tamanho_arena_nomes, &capacidade_arena_nomes,
+                                           nome, (int)strlen(nome) + 1, 1, "nomes dos hospedes");
+    return posicao;
+}
+
+void historico_anexar(Hospede *h, int id_reserva) { // Anexa um ID ao histórico (no servidor, com trava_historicos)
+    int posicao = h->num_reservas_historico % IDS_POR_BLOCO_HISTORICO;
+    if (posicao == 0) {                    // Histórico vazio ou último bloco cheio: encadeia um bloco novo
+        int novo = tamanho_pool_historicos / TAM_BLOCO_HISTORICO;
+        pool_historicos = (int *)crescer_vetor(pool_historicos, &capacidade_pool_historicos,
+                                               tamanho_pool_historicos + TAM_BLOCO_HISTORICO, sizeof(int),
+                                               "historico dos hospedes");
+        tamanho_pool_historicos += TAM_BLOCO_HISTORICO;
+        pool_historicos[novo * TAM_BLOCO_HISTORICO + IDS_POR_BLOCO_HISTORICO] = -1;
+        if (h->num_reservas_historico == 0) {
+            h->primeiro_bloco_historico = novo;
+        } else {
+            pool_historicos[h->ultimo_bloco_historico * TAM_BLOCO_HISTORICO + IDS_POR_BLOCO_HISTORICO] = novo;
+        }
+        h->ultimo_bloco_historico = novo;
+    }
+    pool_historicos[h->ultimo_bloco_historico * TAM_BLOCO_HISTORICO + posicao] = id_reserva;
+    h->num_reservas_historico++;
+}
+
+int historico_copiar(const Hospede *h, int *ids) { // Copia os IDs do histórico, em ordem; retorna a quantidade
+    int bloco = h->primeiro_bloco_historico;
+    for (int i = 0; i < h->num_reservas_historico; i++) {
+        if (i > 0 && i % IDS_POR_BLOCO_HISTORICO == 0) {
+            bloco = pool_historicos[bloco * TAM_BLOCO_HISTORICO + IDS_POR_BLOCO_HISTORICO]; // Próximo bloco
+        }
+        ids[i] = pool_historicos[bloco * TAM_BLOCO_HISTORICO + i % IDS_POR_BLOCO_HISTORICO];
+    }
+    return h->num_reservas_historico;
+}
+
+//INDICE HASH DE CPF
+unsigned long hash_texto(const char *texto) { // Hash FNV-1a de uma string (palavras do índice de nomes)
+    unsigned long h = 2166136261UL;
+    for (; *texto != '\0'; texto++) {
+        h ^= (unsigned char)*texto;
+        h *= 16777619UL;
+    }
+    return h;
+}
+
+unsigned long hash_cpf(unsigned long long cpf) { // Mistura os bits do CPF (finalizador do MurmurHash3)
+    cpf ^= cpf >> 33;
+    cpf *= 0xFF51AFD7ED558CCDULL;
+    cpf ^= cpf >> 33;
+    return (unsigned long)cpf;
+}
+
+void indice_cpf_posicionar(int indice_hospede) { // Coloca um hóspede na tabela (sondagem linear)
+    unsigned long mascara = (unsigned long)capacidade_indice_cpf - 1;
+    unsigned long pos = hash_cpf(hospedes_hotel[indice_hospede].cpf) & mascara;
+    while (indice_cpf[pos] != -1) {        // Avança até a primeira posição vazia
+        pos = (pos + 1) & mascara;
+    }
+    indice_cpf[pos] = indice_hospede;
+}
+void indice_cpf_adicionar(int indice_hospede) { // Registra no índice um hóspede recém-cadastrado
+    if ((contador_hospedes + 1) * 2 > capacidade_indice_cpf) { // Mantém ocupação <= 50%: dobra e reinsere todos
+        int nova_capacidade = (capacidade_indice_cpf == 0) ? 64 : capacidade_indice_cpf * 2;
+        int *temp = (int *)malloc(nova_capacidade * sizeof(int));
+        if (temp == NULL) {                // Verifica falha de alocação
+            fprintf(stderr, "Erro fatal: Nao foi possivel alocar memoria para o indice de CPF!\n");
+            exit(1);
+        }
+        free(indice_cpf);
+        indice_cpf = temp;
+        capacidade_indice_cpf = nova_capacidade;
+        memset(indice_cpf, -1, nova_capacidade * sizeof(int)); // Todas as posições vazias (-1)
+        for (int i = 0; i < contador_hospedes; i++) {
+            if (i != indice_hospede) indice_cpf_posicionar(i); // Reinsere os já cadastrados
+        }
+    }
+    indice_cpf_posicionar(indice_hospede);
+}
+
+int buscar_hospede_por_codigo_cpf(unsigned long long cpf) { // Índice do hóspede pelo CPF codificado, em O(1) esperado
+    if (capacidade_indice_cpf == 0) {      // Nenhum hóspede cadastrado ainda
+        return -1;
+    }
+    MEDIR_INICIO(MEDIDA_BUSCAR_HOSPEDE);
+    int encontrado = -1;                   // -1 se não encontrar
+    long sondagens = 1;                    // Posições lidas na tabela
+    unsigned long mascara = (unsigned long)capacidade_indice_cpf - 1;
+    unsigned long pos = hash_cpf(cpf) & mascara;
+    while (indice_cpf[pos] != -1) {        // Sonda até achar o CPF ou uma posição vazia
+        if (hospedes_hotel[indice_cpf[pos]].cpf == cpf) { // Igualdade de CPF: uma comparação de inteiros
+            encontrado = indice_cpf[pos];  // Índice no array
+            break;
+        }
+        pos = (pos + 1) & mascara;
+        sondagens++;
+    }
+    MEDIR_FIM(MEDIDA_BUSCAR_HOSPEDE, sondagens);
+    return encontrado;
+}
+
+int buscar_hospede_por_cpf(const char *cpf_procurado) { // Retorna índice do hóspede pelo CPF digitado; -1 se inválido ou ausente
+    unsigned long long cpf;
+    return codificar_cpf(cpf_procurado, &cpf) ? buscar_hospede_por_codigo_cpf(cpf) : -1;
+}
+
+//INDICE DE NOMES DE HOSPEDES (PREFIXO E BUSCA APROXIMADA)
+// Nomes são normalizados: minúsculas sem acento, só letras e dígitos, palavras separadas por um espaço.
+// Cada palavra distinta entra no vocabulário com a lista dos hóspedes que a têm. A consulta casa palavra
+// a palavra, em qualquer ordem: a última palavra vale como prefixo (vocabulário em ordem alfabética, busca
+// binária) e cada palavra tolera até 1 ou 2 erros de digitação (distância de Damerau com alinhamento ótimo:
+// trocar duas letras vizinhas conta 1). Os candidatos aproximados vêm das listas de palavras por trigrama:
+// inserção, remoção ou substituição desfaz até 3 trigramas da consulta e a troca de vizinhas até 4, então
+// uma palavra a até d edições está em uma das 4d + 1 listas menores. Com d = 1 bastam as 4 menores, porque
+// as trocas de vizinhas são procuradas direto no vocabulário (variantes da consulta).
+// Os hóspedes percorridos são os da palavra da consulta com menos hóspedes, em ordem de ID; cada um é
+// conferido pelos IDs das palavras do próprio nome. Palavras novas entram no fim do vetor alfabético;
+// a consulta seguinte as intercala.
+int *palavras_dos_hospedes = NULL;      // IDs de palavra dos nomes, hóspede após hóspede
+int contador_palavras_hospedes = 0;     // Posições usadas em palavras_dos_hospedes
+int capacidade_palavras_hospedes = 0;   // Posições alocadas em palavras_dos_hospedes
+int *inicio_palavras_hospede = NULL;    // Hóspede i: palavras_dos_hospedes[inicio[i] .. inicio[i + 1])
+int capacidade_inicio_palavras = 0;     // Posições alocadas em inicio_palavras_hospede
+char (*palavras_nomes)[TAM_NOME] = NULL; // Vocabulário: palavras distintas dos nomes, por ID de palavra
+ListaInteiros *hospedes_da_palavra = NULL; // Hóspedes de cada palavra (índices crescentes)
+int contador_palavras = 0;              // Palavras no vocabulário
+int capacidade_palavras = 0;            // Posições alocadas em palavras_nomes
+int capacidade_hospedes_da_palavra = 0; // Posições alocadas em hospedes_da_palavra
+int *indice_palavras = NULL;            // Tabela hash palavra -> ID (sondagem linear); -1 = vazio
+int capacidade_indice_palavras = 0;     // Posições da tabela hash (potência de 2)
+int *palavras_em_ordem = NULL;          // IDs de palavra; [0, palavras_ordenadas) em ordem alfabética
+int capacidade_palavras_em_ordem = 0;   // Posições alocadas em palavras_em_ordem
+int palavras_ordenadas = 0;             // Parte já ordenada; as seguintes são palavras novas
+ListaInteiros *palavras_do_trigrama = NULL; // IDs das palavras que contêm cada trigrama (NUM_TRIGRAMAS listas)
+
+int normalizar_nome(const char *nome, char *saida) { // Escreve o nome normalizado em 'saida'; retorna o tamanho
+    // Letra sem acento de cada caractere U+00C0..U+00FF ('.' = separador)
+    static const char sem_acento[65] = "aaaaaaaceeeeiiiidnooooo.ouuuuy.saaaaaaaceeeeiiiidnooooo.ouuuuy.y";
+    // Letra base de cada caractere U+0100..U+017F (Latim Estendido-A: Ł, Ś, Ž, ...)
+    static const char latim_estendido[129] = "aaaaaaccccccccddddeeeeeeeeeegggggggghhhhiiiiiiiiiiiijjkkklllllll"
+                                             "lllnnnnnnnnnoooooooorrrrrrssssssssttttttuuuuuuuuuuuuwwyyyzzzzzzs";
+    int tamanho = 0;
+    for (const unsigned char *c = (const unsigned char *)nome; *c != '\0' && tamanho < TAM_NOME - 1; c++) {
+        char letra = '.';
+        if ((*c >= 'a' && *c <= 'z') || (*c >= '0' && *c <= '9')) {
+            letra = (char)*c;
+        } else if (*c >= 'A' && *c <= 'Z') {
+            letra = (char)(*c - 'A' + 'a');
+        } else if (*c >= 0xC2 && *c <= 0xDF && c[1] >= 0x80 && c[1] <= 0xBF) { // UTF-8 de 2 bytes: U+0080..U+07FF
+            int ponto = ((*c & 0x1F) << 6) | (c[1] & 0x3F);
+            c++;
+            if (ponto >= 0xC0 && ponto <= 0xFF) {
+                letra = sem_acento[ponto - 0xC0];
+            } else if (ponto >= 0x100 && ponto <= 0x17F) {
+                letra = latim_estendido[ponto - 0x100];
+            } else if (ponto > 0x17F) {    // Outros alfabetos e acentos combinantes: somem sem partir a palavra
+                continue;
+            }                              // U+0080..U+00BF (espaços e símbolos) separam palavras
+        } else if (*c >= 0xC0) {           // Byte que não forma UTF-8 válido: Latin-1
+            letra = sem_acento[*c - 0xC0];
+        }
+        if (letra != '.') {
+            saida[tamanho++] = letra;
+        } else if (tamanho > 0 && saida[tamanho - 1] != ' ') {
+            saida[tamanho++] = ' ';        // Separadores seguidos viram um espaço
+        }
+    }
+    if (tamanho > 0 && saida[tamanho - 1] == ' ') tamanho--; // Sem espaço no fim
+    saida[tamanho] = '\0';
+    return tamanho;
+}
+
+int separar_palavras(char *texto, char **palavras) { // Divide o nome normalizado (in-place); retorna a quantidade
+    int quantidade = 0;
+    while (*texto != '\0') {
+        palavras[quantidade++] = texto;
+        while (*texto != '\0' && *texto != ' ') texto++;
+        if (*texto == ' ') *texto++ = '\0';
+    }
+    return quantidade;
+}
+
+int codigo_trigrama(const char *texto) {   // Número da lista do trigrama em texto[0..2] (espaço, a-z, 0-9)
+    int codigo = 0;
+    for (int p = 0; p < 3; p++) {
+        char c = texto[p];
+        codigo = codigo * NUM_SIMBOLOS_NOME + ((c == ' ') ? 0 : (c >= 'a' && c <= 'z') ? 1 + (c - 'a') : 27 + (c - '0'));
+    }
+    return codigo;
+}
+
+int trigramas_palavra(const char *palavra, int *codigos) { // Trigramas distintos da palavra com um espaço em cada borda
+    char com_bordas[TAM_NOME + 2];
+    int tamanho = (int)strlen(palavra), distintos = 0;
+    sprintf(com_bordas, " %s ", palavra);
+    for (int p = 0; p < tamanho; p++) {
+        int codigo = codigo_trigrama(com_bordas + p), repetido = 0;
+        for (int q = 0; q < distintos && !repetido; q++) repetido = (codigos[q] == codigo);
+        if (!repetido) codigos[distintos++] = codigo;
+    }
+    return distintos;
+}
+
+int buscar_palavra(const char *palavra) {  // ID da palavra no vocabulário, ou -1
+    if (capacidade_indice_palavras == 0) return -1;
+    unsigned long mascara = (unsigned long)capacidade_indice_palavras - 1;
+    for (unsigned long pos = hash_texto(palavra) & mascara; indice_palavras[pos] != -1; pos = (pos + 1) & mascara) {
+        if (strcmp(palavras_nomes[indice_palavras[pos]], palavra) == 0) return indice_palavras[pos];
+    }
+    return -1;
+}
+
+void indice_palavras_posicionar(int id_palavra) { // Coloca uma palavra na tabela hash (sondagem linear)
+    unsigned long mascara = (unsigned long)capacidade_indice_palavras - 1;
+    unsigned long pos = hash_texto(palavras_nomes[id_palavra]) & mascara;
+    while (indice_palavras[pos] != -1) pos = (pos + 1) & mascara;
+    indice_palavras[pos] = id_palavra;
+}
+
+int registrar_palavra(const char *palavra) { // ID da palavra, incluindo-a no vocabulário se for nova
+    int id_palavra = buscar_palavra(palavra);
+    if (id_palavra != -1) return id_palavra;
+    id_palavra = contador_palavras++;
+    palavras_nomes = (char (*)[TAM_NOME])crescer_vetor(palavras_nomes, &capacidade_palavras, contador_palavras,
+                                                       TAM_NOME, "indice de nomes");
+    strcpy(palavras_nomes[id_palavra], palavra);
+    int capacidade_anterior = capacidade_hospedes_da_palavra;
+    hospedes_da_palavra = (ListaInteiros *)crescer_vetor(hospedes_da_palavra, &capacidade_hospedes_da_palavra,
+                                                         contador_palavras, sizeof(ListaInteiros), "indice de nomes");
+    memset(&hospedes_da_palavra[capacidade_anterior], 0,
+           (capacidade_hospedes_da_palavra - capacidade_anterior) * sizeof(ListaInteiros));
+    if (contador_palavras * 2 > capacidade_indice_palavras) { // Ocupação <= 50%: dobra e reinsere todas
+        free(indice_palavras);
+        capacidade_indice_palavras = (capacidade_indice_palavras == 0) ? 64 : capacidade_indice_palavras * 2;
+        indice_palavras = (int *)malloc(capacidade_indice_palavras * sizeof(int));
+        if (indice_palavras == NULL) {     // Verifica falha de alocação
+            fprintf(stderr, "Erro fatal: Nao foi possivel alocar memoria para o indice de nomes!\n");
+            exit(1);
+        }
+        memset(indice_palavras, -1, capacidade_indice_palavras * sizeof(int));
+        for (int p = 0; p < id_palavra; p++) indice_palavras_posicionar(p);
+    }
+    indice_palavras_posicionar(id_palavra);
+    palavras_em_ordem = (int *)crescer_vetor(palavras_em_ordem, &capacidade_palavras_em_ordem, contador_palavras,
+                                             sizeof(int), "indice de nomes");
+    palavras_em_ordem[id_palavra] = id_palavra; // Fim do vetor alfabético: intercalada na próxima consulta
+    if (palavras_do_trigrama == NULL) {
+        palavras_do_trigrama = (ListaInteiros *)calloc(NUM_TRIGRAMAS, sizeof(ListaInteiros));
+        if (palavras_do_trigrama == NULL) { // Verifica falha de alocação
+            fprintf(stderr, "Erro fatal: Nao foi possivel alocar memoria para o indice de nomes!\n");
+            exit(1);
+        }
+    }
+    int codigos[TAM_NOME];
+    int distintos = trigramas_palavra(palavra, codigos);
+    for (int t = 0; t < distintos; t++) {
+        ListaInteiros *lista = &palavras_do_trigrama[codigos[t]];
+        lista->itens = (int *)anexar_registros(lista->itens, &lista->quantidade, &lista->capacidade,
+                                               &id_palavra, 1, sizeof(int), "indice de nomes");
+    }
+    return id_palavra;
+}
+
+void indice_nomes_adicionar(int indice_hospede) { // Registra o nome de um hóspede recém-cadastrado (IDs em ordem)
+    char texto[TAM_NOME];
+    char *palavras[TAM_NOME / 2];
+    inicio_palavras_hospede = (int *)crescer_vetor(inicio_palavras_hospede, &capacidade_inicio_palavras,
+                                                   indice_hospede + 2, sizeof(int), "indice de nomes");
+    inicio_palavras_hospede[indice_hospede] = contador_palavras_hospedes;
+    normalizar_nome(nome_hospede(&hospedes_hotel[indice_hospede]), texto);
+    int quantidade = separar_palavras(texto, palavras);
+    for (int w = 0; w < quantidade; w++) {
+        int id_palavra = registrar_palavra(palavras[w]); // Pode realocar hospedes_da_palavra
+        ListaInteiros *lista = &hospedes_da_palavra[id_palavra];
+        if (lista->quantidade > 0 && lista->itens[lista->quantidade - 1] == indice_hospede) continue; // Palavra repetida no nome
+        lista->itens = (int *)anexar_registros(lista->itens, &lista->quantidade, &lista->capacidade,
+                                               &indice_hospede, 1, sizeof(int), "indice de nomes");
+        palavras_dos_hospedes = (int *)anexar_registros(palavras_dos_hospedes, &contador_palavras_hospedes,
+                                                        &capacidade_palavras_hospedes, &id_palavra, 1, sizeof(int),
+                                                        "indice de nomes");
+    }
+    inicio_palavras_hospede[indice_hospede + 1] = contador_palavras_hospedes;
+}
+
+int comparar_palavras(const void *a, const void *b) { // Ordem alfabética dos IDs de palavra (qsort)
+    return strcmp(palavras_nomes[*(const int *)a], palavras_nomes[*(const int *)b]);
+}
+
+int indice_nomes_preparar() {              // Intercala as palavras novas no vetor alfabético; 0 se precisa de acesso exclusivo
+    if (palavras_ordenadas == contador_palavras) return 1;
+    if (!acesso_exclusivo) return 0;       // Servidor: repete com a trava exclusiva
+    qsort(palavras_em_ordem + palavras_ordenadas, contador_palavras - palavras_ordenadas, sizeof(int),
+          comparar_palavras);
+    if (palavras_ordenadas > 0) {          // Intercalação O(n) com a parte já ordenada
+        int *temp = (int *)malloc(contador_palavras * sizeof(int));
+        if (temp == NULL) {                // Verifica falha de alocação
+            fprintf(stderr, "Erro fatal: Nao foi possivel alocar memoria para o indice de nomes!\n");
+            exit(1);
+        }
+        int a = 0, b = palavras_ordenadas, n = 0;
+        while (a < palavras_ordenadas && b < contador_palavras) {
+            temp[n++] = (comparar_palavras(&palavras_em_ordem[b], &palavras_em_ordem[a]) < 0) ?
+                        palavras_em_ordem[b++] : palavras_em_ordem[a++];
+        }
+        while (a < palavras_ordenadas) temp[n++] = palavras_em_ordem[a++];
+        while (b < contador_palavras) temp[n++] = palavras_em_ordem[b++];
+        memcpy(palavras_em_ordem, temp, contador_palavras * sizeof(int));
+        free(temp);
+    }
+    palavras_ordenadas = contador_palavras;
+    return 1;
+}
+
+int distancia_edicao(const char *a, const char *b, int limite) { // Damerau (troca de vizinhas = 1), ou limite + 1 se passar
+    int tamanho_a = (int)strlen(a), tamanho_b = (int)strlen(b);
+    if (tamanho_a - tamanho_b > limite || tamanho_b - tamanho_a > limite) return limite + 1;
+    int tabela[3][TAM_NOME + 1];           // Três últimas linhas da programação dinâmica (a troca olha duas atrás)
+    int *antes = tabela[0], *acima = tabela[1], *linha = tabela[2];
+    for (int j = 0; j <= tamanho_b; j++) acima[j] = j;
+    for (int i = 1; i <= tamanho_a; i++) {
+        int menor = linha[0] = i;
+        for (int j = 1; j <= tamanho_b; j++) {
+            int custo = acima[j - 1] + (a[i - 1] != b[j - 1]); // Substituição (ou letra igual)
+            if (acima[j] + 1 < custo) custo = acima[j] + 1; // Remoção
+            if (linha[j - 1] + 1 < custo) custo = linha[j - 1] + 1; // Inserção
+            if (i > 1 && j > 1 && a[i - 1] == b[j - 2] && a[i - 2] == b[j - 1] && antes[j - 2] + 1 < custo) {
+                custo = antes[j - 2] + 1;  // Troca de duas letras vizinhas
+            }
+            linha[j] = custo;
+            if (custo < menor) menor = custo;
+        }
+        if (menor > limite) return limite + 1; // A linha toda passou do limite: não volta a cair
+        int *livre = antes;                // Roda as linhas: a atual passa a ser a de cima
+        antes = acima;
+        acima = linha;
+        linha = livre;
+    }
+    return (acima[tamanho_b] <= limite) ? acima[tamanho_b] : limite + 1;
+}
+
+int distancia_palavra(const char *consulta, const char *palavra, int limite, int prefixo) {
+    // 0 se iguais (ou se 'palavra' começa pela consulta, com 'prefixo'); senão as edições, até limite + 1
+    size_t tamanho = strlen(consulta);
+    if (prefixo ? strncmp(palavra, consulta, tamanho) == 0 : strcmp(palavra, consulta) == 0) return 0;
+    return (limite > 0) ? distancia_edicao(consulta, palavra, limite) : 1;
+}
+
+int comparar_inteiros(const void *a, const void *b) { // Ordem crescente de int (qsort)
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+int distancia_candidata(const ListaInteiros *candidatas, int id_palavra) { // Edições da palavra entre as candidatas, ou -1
+    int esquerda = 0, direita = candidatas->quantidade; // Itens = ID * 4 + edições, em ordem crescente
+    while (esquerda < direita) {
+        int meio = esquerda + (direita - esquerda) / 2;
+        if (candidatas->itens[meio] < id_palavra * 4) esquerda = meio + 1;
+        else direita = meio;
+    }
+    return (esquerda < candidatas->quantidade && candidatas->itens[esquerda] / 4 == id_palavra) ?
+           candidatas->itens[esquerda] % 4 : -1;
+}
+
+void heap_descer(long long *heap, int tamanho, int p) { // Restaura o heap mínimo a partir da posição p
+    while (2 * p + 1 < tamanho) {
+        int filho = 2 * p + 1;
+        if (filho + 1 < tamanho && heap[filho + 1] < heap[filho]) filho++;
+        if (heap[p] <= heap[filho]) break;
+        long long troca = heap[p];
+        heap[p] = heap[filho];
+        heap[filho] = troca;
+        p = filho;
+    }
+}
+
+int buscar_hospedes_por_nome(const char *texto, int k, ResultadoNome *resultados) {
+    // Até k hóspedes (k <= MAX_RESULTADOS_NOME) com todas as palavras da consulta, em ordem de (edições, ID);
+    // -1 se o vocabulário precisa ser intercalado e não há acesso exclusivo
+    if (!indice_nomes_preparar()) return -1;
+    MEDIR_INICIO(MEDIDA_BUSCAR_NOME);
+    char consulta[TAM_NOME];
+    char *palavras[TAM_NOME / 2];
+    ListaInteiros candidatas[TAM_NOME / 2]; // Palavras do vocabulário que casam com cada palavra da consulta
+    int limites[TAM_NOME / 2];             // Edições toleradas em cada palavra da consulta
+    normalizar_nome(texto, consulta);
+    int num_palavras = separar_palavras(consulta, palavras);
+    int encontrados = 0, examinados = 0, condutora = -1, minimo_total = 0;
+    long menor_total = 0;
+
+    for (int w = 0; w < num_palavras; w++) {
+        int codigos[TAM_NOME];
+        int distintos = trigramas_palavra(palavras[w], codigos);
+        int tamanho = (int)strlen(palavras[w]);
+        int prefixo = (w == num_palavras - 1); // A última palavra pode estar incompleta
+        limites[w] = (distintos < 4) ? 0 : (distintos < 9) ? 1 : MAX_DISTANCIA_NOME; // Filtro precisa de 4 (d = 1) ou 4d + 1 listas
+        candidatas[w].itens = NULL;
+        candidatas[w].quantidade = candidatas[w].capacidade = 0;
+        if (prefixo) {                     // Faixa alfabética das palavras que começam pela consulta
+            int esquerda = 0, direita = palavras_ordenadas;
+            while (esquerda < direita) {
+                int meio = esquerda + (direita - esquerda) / 2;
+                if (strcmp(palavras_nomes[palavras_em_ordem[meio]], palavras[w]) < 0) esquerda = meio + 1;
+                else direita = meio;
+            }
+            for (; esquerda < palavras_ordenadas &&
+                   strncmp(palavras_nomes[palavras_em_ordem[esquerda]], palavras[w], tamanho) == 0; esquerda++) {
+                int item = palavras_em_ordem[esquerda] * 4;
+                candidatas[w].itens = (int *)anexar_registros(candidatas[w].itens, &candidatas[w].quantidade,
+                                                              &candidatas[w].capacidade, &item, 1, sizeof(int),
+                                                              "busca de nomes");
+            }
+        } else {
+            int item = buscar_palavra(palavras[w]) * 4;
+            if (item >= 0) {
+                candidatas[w].itens = (int *)anexar_registros(candidatas[w].itens, &candidatas[w].quantidade,
+                                                              &candidatas[w].capacidade, &item, 1, sizeof(int),
+                                                              "busca de nomes");
+            }
+        }
+        int minimo = (candidatas[w].quantidade > 0) ? 0 : limites[w] + 1; // Menos edições possíveis nesta palavra
+        if (limites[w] > 0) {              // Trocas de letras vizinhas: o filtro de trigramas com d = 1 não as garante
+            char variante[TAM_NOME];
+            strcpy(variante, palavras[w]);
+            for (int p = 0; p + 1 < tamanho; p++) {
+                if (variante[p] == variante[p + 1]) continue;
+                char troca = variante[p];
+                variante[p] = variante[p + 1];
+                variante[p + 1] = troca;
+                int item = buscar_palavra(variante) * 4 + 1;
+                if (item >= 0) {           // Repetidas com o filtro abaixo saem depois da ordenação
+                    candidatas[w].itens = (int *)anexar_registros(candidatas[w].itens, &candidatas[w].quantidade,
+                                                                  &candidatas[w].capacidade, &item, 1, sizeof(int),
+                                                                  "busca de nomes");
+                    if (minimo > 1) minimo = 1;
+                }
+                variante[p + 1] = variante[p];
+                variante[p] = troca;
+            }
+        }
+        if (limites[w] > 0 && palavras_do_trigrama != NULL) { // Aproximadas: união das listas menores
+            int listas = (limites[w] == 1) ? 4 : 4 * limites[w] + 1;
+            for (int a = 1; a < distintos; a++) { // Ordena os trigramas pelo tamanho da lista (poucos: inserção)
+                int codigo = codigos[a], b = a;
+                while (b > 0 && palavras_do_trigrama[codigos[b - 1]].quantidade > palavras_do_trigrama[codigo].quantidade) {
+                    codigos[b] = codigos[b - 1];
+                    b--;
+                }
+                codigos[b] = codigo;
+            }
+            int posicoes[4 * MAX_DISTANCIA_NOME + 1] = {0};
+            while (1) {
+                int palavra = -1;          // Menor ID ainda não visto entre as listas (listas crescentes)
+                for (int l = 0; l < listas; l++) {
+                    const ListaInteiros *lista = &palavras_do_trigrama[codigos[l]];
+                    if (posicoes[l] < lista->quantidade && (palavra == -1 || lista->itens[posicoes[l]] < palavra)) {
+                        palavra = lista->itens[posicoes[l]];
+                    }
+                }
+                if (palavra == -1) break;
+                for (int l = 0; l < listas; l++) {
+                    const ListaInteiros *lista = &palavras_do_trigrama[codigos[l]];
+                    if (posicoes[l] < lista->quantidade && lista->itens[posicoes[l]] == palavra) posicoes[l]++;
+                }
+                int distancia = distancia_palavra(palavras[w], palavras_nomes[palavra], limites[w], prefixo);
+                if (distancia > 0 && distancia <= limites[w]) { // As de distância 0 já estão na lista
+                    int item = palavra * 4 + distancia;
+                    candidatas[w].itens = (int *)anexar_registros(candidatas[w].itens, &candidatas[w].quantidade,
+                                                                  &candidatas[w].capacidade, &item, 1, sizeof(int),
+                                                                  "busca de nomes");
+                    if (distancia < minimo) minimo = distancia;
+                }
+            }
+        }
+        if (candidatas[w].quantidade > 1) {
+            qsort(candidatas[w].itens, candidatas[w].quantidade, sizeof(int), comparar_inteiros);
+            int unicas = 1;                // Mesma palavra achada pela troca e pelo filtro: fica uma vez
+            for (int c = 1; c < candidatas[w].quantidade; c++) {
+                if (candidatas[w].itens[c] != candidatas[w].itens[unicas - 1]) candidatas[w].itens[unicas++] = candidatas[w].itens[c];
+            }
+            candidatas[w].quantidade = unicas;
+        }
+        minimo_total += minimo;
+        long total = 0;                    // Hóspedes a percorrer se esta palavra conduzir a busca
+        for (int c = 0; c < candidatas[w].quantidade; c++) total += hospedes_da_palavra[candidatas[w].itens[c] / 4].quantidade;
+        if (condutora == -1 || total < menor_total) {
+            condutora = w;
+            menor_total = total;
+        }
+    }
+
+    if (condutora != -1 && menor_total > 0 && k > 0) {
+        // União das listas da condutora em ordem de ID (heap de ID << 32 | lista): cada hóspede aparece uma vez
+        const ListaInteiros *listas = &candidatas[condutora];
+        long long *heap = (long long *)malloc(listas->quantidade * sizeof(long long));
+        int *posicoes = (int *)calloc(listas->quantidade, sizeof(int));
+        if (heap == NULL || posicoes == NULL) { // Verifica falha de alocação
+            fprintf(stderr, "Erro fatal: Nao foi possivel alocar memoria para a busca de nomes!\n");
+            exit(1);
+        }
+        int tamanho_heap = 0, ultimo = -1;
+        for (int c = 0; c < listas->quantidade; c++) {
+            const ListaInteiros *lista = &hospedes_da_palavra[listas->itens[c] / 4];
+            if (lista->quantidade > 0) heap[tamanho_heap++] = ((long long)lista->itens[0] << 32) | c;
+        }
+        for (int p = tamanho_heap / 2 - 1; p >= 0; p--) heap_descer(heap, tamanho_heap, p);
+        while (tamanho_heap > 0) {
+            int indice_hospede = (int)(heap[0] >> 32), c = (int)(heap[0] & 0xFFFFFFFF);
+            const ListaInteiros *lista = &hospedes_da_palavra[listas->itens[c] / 4];
+            if (++posicoes[c] < lista->quantidade) heap[0] = ((long long)lista->itens[posicoes[c]] << 32) | c;
+            else heap[0] = heap[--tamanho_heap];
+            heap_descer(heap, tamanho_heap, 0);
+            if (indice_hospede == ultimo) continue; // Hóspede com duas palavras candidatas
+            ultimo = indice_hospede;
+            if (encontrados == k && resultados[k - 1].distancia <= minimo_total) break; // IDs seguintes não entram
+            examinados++;
+            int total = 0;
+            for (int w = 0; w < num_palavras && total >= 0; w++) {
+                int melhor = -1;           // Menos edições entre as palavras do nome para a palavra w
+                for (int p = inicio_palavras_hospede[indice_hospede]; p < inicio_palavras_hospede[indice_hospede + 1]; p++) {
+                    int distancia = distancia_candidata(&candidatas[w], palavras_dos_hospedes[p]);
+                    if (distancia != -1 && (melhor == -1 || distancia < melhor)) melhor = distancia;
+                }
+                total = (melhor == -1) ? -1 : total + melhor;
+            }
+            if (total < 0) continue;       // Alguma palavra da consulta não casou
+            int p = encontrados;           // Insere em ordem de (edições, ID), só os k melhores
+            while (p > 0 && resultados[p - 1].distancia > total) p--;
+            if (p >= k) continue;
+            memmove(&resultados[p + 1], &resultados[p], ((encontrados < k ? encontrados : k - 1) - p) * sizeof(ResultadoNome));
+            resultados[p].indice_hospede = indice_hospede;
+            resultados[p].distancia = total;
+            if (encontrados < k) encontrados++;
+        }
+        free(heap);
+        free(posicoes);
+    }
+    for (int w = 0; w < num_palavras; w++) free(candidatas[w].itens);
+    MEDIR_FIM(MEDIDA_BUSCAR_NOME, examinados); // Hóspedes conferidos
+    return encontrados;
+}
+
+void indice_nomes_liberar() {              // Libera vocabulário, listas e palavras de cada hóspede
+    for (int p = 0; p < contador_palavras; p++) {
+        free(hospedes_da_palavra[p].itens);
+    }
+    if (palavras_do_trigrama != NULL) {
+        for (int t = 0; t < NUM_TRIGRAMAS; t++) {
+            free(palavras_do_trigrama[t].itens);
+        }
+        free(palavras_do_trigrama);
+    }
+    free(hospedes_da_palavra);
+    free(palavras_nomes);
+    free(indice_palavras);
+    free(palavras_em_ordem);
+    free(palavras_dos_hospedes);
+    free(inicio_palavras_hospede);
+    palavras_do_trigrama = hospedes_da_palavra = NULL; // Índice vazio, pronto para ser refeito (ver liberar_tabelas)
+    palavras_nomes = NULL;
+    indice_palavras = palavras_em_ordem = palavras_dos_hospedes = inicio_palavras_hospede = NULL;
+    contador_palavras = capacidade_palavras = capacidade_hospedes_da_palavra = 0;
+    capacidade_indice_palavras = capacidade_palavras_em_ordem = palavras_ordenadas = 0;
+    contador_palavras_hospedes = capacidade_palavras_hospedes = capacidade_inicio_palavras = 0;
+}
+
+int inserir_hospede(const char *cpf, const char *nome, const char *telefone, int *id_gerado) { // Núcleo do cadastro de hóspede
+    unsigned long long cpf_codificado, telefone_codificado;
+    if (strlen(nome) >= TAM_NOME) {
+        return ERRO_PARAMETRO_INVALIDO;   // Nome maior que o aceito pelos registros de arquivo
+    }
+    if (!codificar_cpf(cpf, &cpf_codificado)) {
+        return ERRO_CPF_INVALIDO;
+    }
+    if (!codificar_telefone(telefone, &telefone_codificado)) {
+        return ERRO_TELEFONE_INVALIDO;
+    }
+    if (buscar_hospede_por_codigo_cpf(cpf_codificado) != -1) { // CPF precisa ser único
+        return ERRO_HOSPEDE_EXISTENTE;
+    }
+    reservar_hospedes(1);                  // Garante espaço para +1 hóspede
+    Hospede *novo_hospede = &hospedes_hotel[contador_hospedes]; // Ponteiro para novo elemento
+    novo_hospede->cpf = cpf_codificado;    // CPF e telefone já codificados
+    novo_hospede->telefone = telefone_codificado;
+    novo_hospede->nome = arena_nomes_adicionar(nome); // Nome vai para a arena
+
+    novo_hospede->id_hospede = contador_hospedes + 1; // Atribui ID sequencial
+    novo_hospede->primeiro_bloco_historico = -1; // Inicializa histórico vazio
+    novo_hospede->ultimo_bloco_historico = -1;
+    novo_hospede->num_reservas_historico = 0;   // Inicializa contagem do histórico
+    indice_cpf_adicionar(contador_hospedes); // Indexa o CPF antes de contabilizar o hóspede
+    indice_hospedes_id_adicionar(contador_hospedes); // E o ID
+    indice_nomes_adicionar(contador_hospedes); // E o nome
+    contador_hospedes++;                 // Incrementa contador global de hóspedes
+    if (arquivo_journal != NULL) {       // Registra a alteração no journal
+        HospedeArquivo registro;
+        memset(&registro, 0, sizeof(registro));
+        registro.id_hospede = novo_hospede->id_hospede;
+        strcpy(registro.nome, nome);
+        texto_cpf(cpf_codificado, registro.cpf); // Forma normalizada: a reaplicação obtém o mesmo código
+        texto_telefone(telefone_codificado, registro.telefone);
+        journal_registrar(JOURNAL_HOSPEDE, &registro, sizeof(registro));
+    }
+    if (id_gerado != NULL) *id_gerado = novo_hospede->id_hospede;
+    return OPERACAO_OK;
+}
+
+void cadastrar_hospede(){                  // Função para cadastrar novo hóspede
+    char cpf_digitado[TAM_CPF];            // Buffer local para CPF digitado
+    char nome_digitado[TAM_NOME];          // Buffer local para nome digitado
+    char telefone_digitado[TAM_TELEFONE];  // Buffer local para telefone digitado
+    int id_gerado;                         // ID atribuído ao novo hóspede
+
+    printf("\nCadastro de Hospede\n");     // Cabeçalho
+
+    int cpf_repetido;                      // Resultado da consulta ao índice de CPF
+    do {                                   // Loop para garantir CPF único
+        printf("Digite o CPF (apenas numeros): ");
+        scanf("%s", cpf_digitado);         // Lê CPF como string
+
+        unsigned long long cpf;
+        if (!codificar_cpf(cpf_digitado, &cpf)) { // Formato inválido: pede de novo
+            printf("ERRO: CPF invalido (informe os 11 digitos).\n");
+            cpf_repetido = 1;
+            continue;
+        }
+        cpf_repetido = buscar_hospede_por_codigo_cpf(cpf) != -1; // Uma única consulta por tentativa
+        if (cpf_repetido) {                // Se CPF já existe, avisa
+            printf("ERRO: O CPF %s ja esta cadastrado.\n", cpf_digitado);
+        }
+    } while (cpf_repetido);                // Repetir enquanto CPF existir
+
+    printf("Digite o nome: ");
+    scanf("%s", nome_digitado);            // Lê nome (sem espaços)
+
+    printf("Digite o telefone: ");
+    scanf("%s", telefone_digitado);        // Lê telefone
+
+    if (inserir_hospede(cpf_digitado, nome_digitado, telefone_digitado, &id_gerado) != OPERACAO_OK) { // Grava o hóspede
+        printf("\nERRO: Dados do hospede invalidos. Cadastro nao realizado.\n");
+        return;
+    }
+    printf("\nHospede %s cadastrado com sucesso! ID: %d\n", nome_digitado, id_gerado); // Confirma
+}
+
+void listar_hospedes() {                  // Lista todos os hóspedes cadastrados
+    printf("\n--- Lista de Hospedes Cadastrados (%d no total) ---\n", contador_hospedes); // Cabeçalho
+    if (contador_hospedes == 0) {         // Se não há hóspedes
+        printf("Nenhum hospede cadastrado ainda.\n");
+        return;
+    }
+    printf("ID   | Nome          | CPF            | Telefone       | Historico Reservas\n"); // Títulos
+    printf("----------------------------------------------------------------------------\n");
+    char cpf[TAM_CPF], telefone[TAM_TELEFONE]; // CPF e telefone decodificados para exibição
+    for (int i = 0; i < contador_hospedes; i++) { // Percorre o array de hóspedes
+        printf("%-4d | %-13s | %-14s | %-14s | Total: %d\n",
+               hospedes_hotel[i].id_hospede,      // Exibe ID do hóspede
+               nome_hospede(&hospedes_hotel[i]),  // Exibe nome
+               texto_cpf(hospedes_hotel[i].cpf, cpf), // Exibe CPF
+               texto_telefone(hospedes_hotel[i].telefone, telefone), // Exibe telefone
+               hospedes_hotel[i].num_reservas_historico); // Exibe número de reservas no histórico
+    }
+}
+
+void buscar_hospede_nome_menu() {          // Busca hóspedes pelo nome (prefixo ou aproximado)
+    char consulta[TAM_NOME];               // Nome ou parte dele, com espaços
+    ResultadoNome resultados[MAX_RESULTADOS_NOME];
+    printf("Digite o nome (ou o inicio dele): ");
+    scanf(" %49[^\n]", consulta);          // Lê a linha inteira (nomes podem ter espaços)
+
+    int encontrados = buscar_hospedes_por_nome(consulta, 20, resultados);
+    if (encontrados <= 0) {
+        printf("Nenhum hospede encontrado.\n");
+        return;
+    }
+    char cpf[TAM_CPF], telefone[TAM_TELEFONE]; // CPF e telefone decodificados para exibição
+    printf("ID   | Nome          | CPF            | Telefone\n");
+    for (int r = 0; r < encontrados; r++) { // Exatos primeiro, depois os aproximados
+        const Hospede *h = &hospedes_hotel[resultados[r].indice_hospede];
+        printf("%-4d | %-13s | %-14s | %-14s%s\n", h->id_hospede, nome_hospede(h), texto_cpf(h->cpf, cpf),
+               texto_telefone(h->telefone, telefone),
+               (resultados[r].distancia > 0) ? " (aproximado)" : "");
+    }
+}
+
+void colunas_reservas(const TabelaReservas *tabela, ColunaReserva *colunas) { // As NUM_COLUNAS_RESERVA colunas, em ordem fixa
+    colunas[0].dados = tabela->id_reserva;     colunas[0].tamanho_elemento = sizeof(int);
+    colunas[1].dados = tabela->numero_quarto;  colunas[1].tamanho_elemento = sizeof(int);
+    colunas[2].dados = tabela->id_hospede;     colunas[2].tamanho_elemento = sizeof(int);
+    colunas[3].dados = tabela->dia_checkin;    colunas[3].tamanho_elemento = sizeof(long);
+    colunas[4].dados = tabela->dia_checkout;   colunas[4].tamanho_elemento = sizeof(long);
+    colunas[5].dados = tabela->status_reserva; colunas[5].tamanho_elemento = sizeof(unsigned char);
+    colunas[6].dados = tabela->valor_centavos; colunas[6].tamanho_elemento = sizeof(long long);
+}
+
+void definir_colunas_reservas(TabelaReservas *tabela, const ColunaReserva *colunas) { // Inverso de colunas_reservas (após realocar)
+    tabela->id_reserva = (int *)colunas[0].dados;
+    tabela->numero_quarto = (int *)colunas[1].dados;
+    tabela->id_hospede = (int *)colunas[2].dados;
+    tabela->dia_checkin = (long *)colunas[3].dados;
+    tabela->dia_checkout = (long *)colunas[4].dados;
+    tabela->status_reserva = (unsigned char *)colunas[5].dados;
+    tabela->valor_centavos = (long long *)colunas[6].dados;
+}
+
+void tabela_reservas_crescer(TabelaReservas *tabela, int *capacidade, int minimo) { // Todas as colunas para 'minimo' posições
+    if (minimo <= *capacidade) {          // Já cabe: nada a fazer
+        return;
+    }
+    ColunaReserva colunas[NUM_COLUNAS_RESERVA];
+    int nova_capacidade = *capacidade;
+    colunas_reservas(tabela, colunas);
+    for (int k = 0; k < NUM_COLUNAS_RESERVA; k++) { // Todas as colunas crescem para a mesma capacidade
+        nova_capacidade = *capacidade;
+        colunas[k].dados = crescer_vetor(colunas[k].dados, &nova_capacidade, minimo, colunas[k].tamanho_elemento, "reserva");
+    }
+    definir_colunas_reservas(tabela, colunas);
+    *capacidade = nova_capacidade;
+}
+
+void tabela_reservas_liberar(TabelaReservas *tabela) { // Libera cada coluna (free(NULL) é seguro)
+    ColunaReserva colunas[NUM_COLUNAS_RESERVA];
+    colunas_reservas(tabela, colunas);
+    for (int k = 0; k < NUM_COLUNAS_RESERVA; k++) {
+        free(colunas[k].dados);
+    }
+}
+
+int total_reservas() {                    // Reservas já feitas: ativas + arquivadas (o próximo ID é este + 1)
+    Hotel *hotel = hotel_atual;
+    return hotel->contador_reservas + hotel->contador_arquivadas;
+}
+
+void reservar_reservas(int adicionais) {  // Garante espaço para mais 'adicionais' reservas ativas (e seus IDs)
+    Hotel *hotel = hotel_atual;
+    tabela_reservas_crescer(&hotel->reservas_hotel, &hotel->capacidade_reservas, hotel->contador_reservas + adicionais);
+    // O índice por ID cresce junto com as reservas: no servidor só cresce com acesso exclusivo
+    hotel->indice_reservas_id = indice_id_crescer(hotel->indice_reservas_id, &hotel->capacidade_indice_reservas_id,
+                                                  total_reservas() + adicionais + 1, "indice de reservas");
+}
+
+void reservar_arquivadas(int adicionais) { // Garante espaço para mais 'adicionais' reservas no arquivo
+    Hotel *hotel = hotel_atual;
+    tabela_reservas_crescer(&hotel->reservas_arquivadas, &hotel->capacidade_arquivadas, hotel->contador_arquivadas + adicionais);
+}
+
+void indice_reservas_id_definir(int id, int posicao, int arquivada) { // Aponta o ID para a posição no conjunto ativo ou no arquivo
+    hotel_atual->indice_reservas_id[id] = arquivada ? -2 - posicao : posicao; // Arquivo: -2, -3, ...; -1 continua "vazio"
+}
+
+int indice_reservas_id_adicionar(const TabelaReservas *tabela, int posicao, int arquivada) { // Registra um ID; 0 se já estava em uso
+    Hotel *hotel = hotel_atual;
+    int id = tabela->id_reserva[posicao];
+    if (id < 0) return 0;
+    hotel->indice_reservas_id = indice_id_crescer(hotel->indice_reservas_id, &hotel->capacidade_indice_reservas_id, id + 1, "indice de reservas");
+    if (hotel->indice_reservas_id[id] != -1) return 0;
+    indice_reservas_id_definir(id, posicao, arquivada);
+    return 1;
+}
+
+void reserva_ler(const TabelaReservas *tabela, int i, Reserva *destino) { // Monta a reserva da posição 'i' a partir das colunas
+    destino->id_reserva = tabela->id_reserva[i];
+    destino->numero_quarto = tabela->numero_quarto[i];
+    destino->id_hospede = tabela->id_hospede[i];
+    destino->dia_checkin = tabela->dia_checkin[i];
+    destino->dia_checkout = tabela->dia_checkout[i];
+    destino->status_reserva = tabela->status_reserva[i];
+    destino->valor_centavos = tabela->valor_centavos[i];
+}
+
+void reserva_gravar(TabelaReservas *tabela, int i, const Reserva *origem) { // Espalha uma reserva inteira nas colunas da posição 'i'
+    tabela->id_reserva[i] = origem->id_reserva;
+    tabela->numero_quarto[i] = origem->numero_quarto;
+    tabela->id_hospede[i] = origem->id_hospede;
+    tabela->dia_checkin[i] = origem->dia_checkin;
+    tabela->dia_checkout[i] = origem->dia_checkout;
+    tabela->status_reserva[i] = (unsigned char)origem->status_reserva;
+    tabela->valor_centavos[i] = origem->valor_centavos;
+}
+
+int registrar_nova_reserva(int indice_hospede, int numero_quarto, long dia_checkin, long dia_checkout,
+                           int *id_gerado, long long *valor_gerado) { // Criação de reserva (ver criar_reserva)
+    Hotel *hotel = hotel_atual;
+    if (indice_hospede < 0 || indice_hospede >= contador_hospedes) { // Hóspede precisa existir
+        return ERRO_HOSPEDE_INEXISTENTE;
+    }
+    int indice_quarto = buscar_quarto_por_numero(numero_quarto); // Busca índice do quarto
+    if (indice_quarto == -1) {            // Quarto não existe
+        return ERRO_QUARTO_INEXISTENTE;
+    }
+    if (dia_checkin == DATA_INVALIDA || dia_checkout == DATA_INVALIDA || dia_checkout <= dia_checkin) {
+        return ERRO_DATAS_INVALIDAS;      // Check-out deve ser posterior ao check-in
+    }
+    travar_se_concorrente(&hotel->travas_quartos[indice_quarto]); // Verificação e ocupação do quarto numa só etapa
+    if (!quarto_livre_periodo(indice_quarto, dia_checkin, dia_checkout)) { // Fora de operação, reservado ou em manutenção no período
+        destravar_se_concorrente(&hotel->travas_quartos[indice_quarto]);
+        return ERRO_QUARTO_INDISPONIVEL;
+    }
+    long long valor_centavos = valor_estadia_centavos(indice_quarto, dia_checkin, dia_checkout); // Diárias com as regras de tarifa
+
+    travar_se_concorrente(&trava_reservas);
+    int id_reserva = total_reservas() + 1;   // IDs sequenciais, contando também as arquivadas
+    if (hotel->contador_reservas == hotel->capacidade_reservas || id_reserva >= hotel->capacidade_indice_reservas_id) { // Tabela cheia
+        if (!acesso_exclusivo) {             // Crescer move a tabela: só com acesso exclusivo
+            destravar_se_concorrente(&trava_reservas);
+            destravar_se_concorrente(&hotel->travas_quartos[indice_quarto]);
+            return ERRO_REPETIR_EXCLUSIVO;
+        }
+        reservar_reservas(1);                // Garante espaço para a nova reserva
+    }
+    Reserva nova_reserva;                    // Montada inteira e espalhada nas colunas
+    nova_reserva.id_reserva = id_reserva;    // Atribui ID sequencial
+    nova_reserva.numero_quarto = numero_quarto; // Guarda número do quarto
+    nova_reserva.id_hospede = hospedes_hotel[indice_hospede].id_hospede; // Liga ao hóspede
+    nova_reserva.dia_checkin = dia_checkin;   // Armazena check-in já convertido
+    nova_reserva.dia_checkout = dia_checkout; // Armazena check-out já convertido
+    nova_reserva.status_reserva = ATIVA;    // Marca reserva como ATIVA
+    nova_reserva.valor_centavos = valor_centavos; // Armazena valor total calculado
+    reserva_gravar(&hotel->reservas_hotel, hotel->contador_reservas, &nova_reserva); // Entra no fim do conjunto ativo
+    indice_reservas_id_definir(id_reserva, hotel->contador_reservas, 0); // Localizável pelo ID em O(1)
+    hotel->contador_reservas++; // Incrementa contador de reservas (publica o registro já preenchido)
+    hotel->versao_reservas++;                // Leituras seguintes precisam de uma vista nova
+    if (arquivo_journal != NULL) {           // Registra a alteração no journal (ainda sob trava_reservas: LSNs na ordem dos IDs)
+        RegistroJournalReserva registro;
+        memset(&registro, 0, sizeof(registro));
+        texto_cpf(hospedes_hotel[indice_hospede].cpf, registro.cpf);
+        registro.numero_quarto = numero_quarto;
+        registro.id_reserva = id_reserva;
+        registro.dia_checkin = dia_checkin;
+        registro.dia_checkout = dia_checkout;
+        journal_registrar(JOURNAL_RESERVA, &registro, sizeof(registro));
+    }
+    destravar_se_concorrente(&trava_reservas);
+    agenda_inserir(indice_quarto, dia_checkin, dia_checkout, id_reserva); // Registra o período na agenda do quarto
+    calendario_reserva_criada(indice_quarto, dia_checkin, dia_checkout); // E nos bitmaps de ocupação
+    analise_registrar(indice_quarto, dia_checkin, dia_checkout, valor_centavos, 1); // Noites vendidas e receita do tipo
+    destravar_se_concorrente(&hotel->travas_quartos[indice_quarto]);
+    if (id_gerado != NULL) *id_gerado = id_reserva;
+    if (valor_gerado != NULL) *valor_gerado = valor_centavos;
+    return OPERACAO_OK;
+}
+
+int criar_reserva(int indice_hospede, int numero_quarto, long dia_checkin, long dia_checkout,
+                  int *id_gerado, long long *valor_gerado) { // Núcleo da criação de reserva (sem prompts; valor em centavos)
+    MEDIR_INICIO(MEDIDA_CRIAR_RESERVA);
+    int codigo = registrar_nova_reserva(indice_hospede, numero_quarto, dia_checkin, dia_checkout, id_gerado, valor_gerado);
+    MEDIR_FIM(MEDIDA_CRIAR_RESERVA, codigo == OPERACAO_OK ? dia_checkout - dia_checkin : 0); // Noites precificadas
+    return codigo;
+}
+
+void realizar_reserva() {                    // Função para criar uma nova reserva
+    Hotel *hotel = hotel_atual;
+    char cpf_busca[TAM_CPF];                 // Buffer para CPF informado
+    int indice_hospede;                      // Índice do hóspede no array
+    int numero_quarto_escolhido;             // Número do quarto escolhido
+    char checkin_str[TAM_DATA];              // String do check-in
+    char checkout_str[TAM_DATA];             // String do check-out
+    int indice_quarto;                       // Índice do quarto no array
+    int validacao = 0;                       // Flag de validação do quarto
+    int verificar_datas = 0;                 // Flag para validação das datas
+    int dias_estadia;                        // Dias calculados entre checkin e checkout
+    long dia_checkin, dia_checkout;          // Datas convertidas em dias absolutos
+    int id_gerado;                           // ID da reserva criada
+    long long valor_centavos;                // Valor total calculado pelo núcleo
+
+    printf("\nREALIZAR RESERVA\n");
+    if(hotel->contador_quartos ==0){ // Se não há quartos cadastrados, aborta operação
+        printf("Nenhum quarto cadastrado no sistema\n");
+        return;
+    }
+
+    do {                                     // Loop para encontrar hóspede existente
+        printf("Digite o CPF do hospede (apenas numeros, ou '0' para cancelar): ");
+        scanf("%s", cpf_busca);              // Lê CPF ou '0' para cancelar
+
+        if (strcmp(cpf_busca, "0") == 0) {   // Se usuário optou por cancelar
+            printf("Operacao de reserva cancelada.\n");
+            return;
+        }
+
+        indice_hospede = buscar_hospede_por_cpf(cpf_busca); // Busca hóspede pelo CPF
+
+        if (indice_hospede == -1) {         // Se não encontrado, avisa e repete
+            printf("ERRO: Hospede nao cadastrado. Tente novamente ou digite '0' para sair.\n");
+        }
+    } while (indice_hospede == -1);         // Repete até encontrar hóspede ou cancelar
+
+    do{                                      // Loop para selecionar quarto disponível
+        printf("QUARTOS DISPONIVEIS\n");
+        listar_quartos();                    // Exibe lista de quartos
+
+        printf("\nDIGITE O NUMERO DO QUARTO ESCOLHIDO (ou caso queira cancelar a reserva digite 0):\n");
+        scanf("%d", &numero_quarto_escolhido); // Lê número do quarto escolhido
+
+        if(numero_quarto_escolhido == 0){    // Se usuário cancelar a seleção
+            printf("RESERVA CANCELADA\n");
+            return;
+        }
+
+        indice_quarto = buscar_quarto_por_numero(numero_quarto_escolhido); // Busca índice do quarto
+        if (indice_quarto == -1) {          // Quarto não existe?
+            printf("ERRO: Quarto %d nao existe. Tente novamente.\n", numero_quarto_escolhido);
+            validacao = 0; 
+        } 
+        else if (hotel->quartos_hotel[indice_quarto].status != LIVRE) { // Fora de operação em qualquer data
+            printf("ERRO: Quarto %d esta fora de operacao. Tente novamente.\n", numero_quarto_escolhido);
+            validacao = 0; 
+        } 
+        else{
+            validacao = 1;                   // Quarto válido; o período é conferido na agenda
+        }
+    }while (validacao == 0);                // Repete enquanto não for válido
+
+    do{                                      // Loop para validar datas
+        printf("Digite a data de Check-in (DD/MM/AAAA): ");
+        scanf("%s", checkin_str);            // Lê check-in
+        printf("Digite a data de Check-out (DD/MM/AAAA): ");
+        scanf("%s", checkout_str);           // Lê check-out
+        dia_checkin = converter_data_em_dias(checkin_str);   // Converte as datas uma única vez
+        dia_checkout = converter_data_em_dias(checkout_str);
+        dias_estadia = (int)(dia_checkout - dia_checkin); // Diferença com sinal: check-out antes do check-in é inválido
+        if (dia_checkin == DATA_INVALIDA || dia_checkout == DATA_INVALIDA) { // Data mal formada
+            printf("ERRO: Data invalida. Use o formato DD/MM/AAAA. Tente novamente\n");
+            verificar_datas = 1;
+        }else if (dias_estadia <= 0) {      // Verifica se check-out é posterior a check-in
+            printf("ERRO: A data de check-out deve ser posterior a de check-in. Tente novamente\n");
+            verificar_datas = 1;
+        }else{
+            verificar_datas = 0;
+        }
+    }while(verificar_datas == 1);           // Repete enquanto datas inválidas
+
+    int codigo = criar_reserva(indice_hospede, numero_quarto_escolhido, dia_checkin, dia_checkout,
+                               &id_gerado, &valor_centavos); // Grava a reserva
+    if (codigo == ERRO_QUARTO_INDISPONIVEL) { // Agenda do quarto já tem reserva ou bloqueio no período
+        printf("ERRO: Quarto %d ja esta reservado ou em manutencao nesse periodo.\n", numero_quarto_escolhido);
+        return;
+    }
+    if (codigo != OPERACAO_OK) {
+        printf("ERRO: Nao foi possivel realizar a reserva.\n");
+        return;
+    }
+    printf("\nReserva %d realizada com sucesso para %s no Quarto %d.\n", id_gerado, nome_hospede(&hospedes_hotel[indice_hospede]), numero_quarto_escolhido); // Mensagem de sucesso
+    printf("Estadia de %d dias. Valor total: R$%.2f\n", dias_estadia, valor_centavos / 100.0); // Mostra resumo da reserva
+}
+
+//VISTA VERSIONADA DAS RESERVAS (LEITURAS ISOLADAS)
+// Listagens e exportações longas leem uma versão imutável das reservas em vez das tabelas vivas. Cada
+// criação, cancelamento ou conclusão avança hotel->versao_reservas sob trava_reservas; a primeira leitura
+// depois disso copia o conjunto ativo (um memcpy por coluna, só ele sob trava_reservas) e as leituras
+// seguintes da mesma versão dividem a cópia, com contagem de referências. O arquivo não é copiado: só
+// recebe acréscimos no fim, então a vista guarda quantas linhas ele tinha. As escritas não copiam nada
+// nem esperam a formatação; uma vista antiga é liberada quando o último leitor a solta.
+VistaReservas *vista_reservas_obter() {   // Vista da versão atual das reservas de hotel_atual (devolver com vista_reservas_soltar)
+    Hotel *hotel = hotel_atual;
+    travar_se_concorrente(&trava_vista);
+    travar_se_concorrente(&trava_reservas); // Versão e colunas lidas juntas
+    VistaReservas *vista = hotel->vista_reservas;
+    if (vista == NULL || vista->versao != hotel->versao_reservas) { // Houve escrita desde a última cópia
+        if (vista != NULL && vista->referencias > 1) { // Leitores ainda usam a versão antiga: fica com eles
+            vista->referencias--;
+            vista = NULL;
+        }
+        if (vista == NULL) {               // Sem leitores, a vista antiga é reaproveitada
+            vista = (VistaReservas *)calloc(1, sizeof(VistaReservas));
+            if (vista == NULL) {
+                fprintf(stderr, "Erro fatal: Nao foi possivel alocar memoria para a vista das reservas!\n");
+                exit(1);
+            }
+            vista->referencias = 1;        // Referência do hotel
+        }
+        tabela_reservas_crescer(&vista->ativas, &vista->capacidade_ativas, hotel->contador_reservas + 1);
+        ColunaReserva origem[NUM_COLUNAS_RESERVA], destino[NUM_COLUNAS_RESERVA];
+        colunas_reservas(&hotel->reservas_hotel, origem);
+        colunas_reservas(&vista->ativas, destino);
+        for (int k = 0; k < NUM_COLUNAS_RESERVA && hotel->contador_reservas > 0; k++) {
+            memcpy(destino[k].dados, origem[k].dados, (size_t)hotel->contador_reservas * origem[k].tamanho_elemento);
+        }
+        vista->num_ativas = hotel->contador_reservas;
+        vista->num_arquivadas = hotel->contador_arquivadas;
+        vista->versao = hotel->versao_reservas;
+        hotel->vista_reservas = vista;
+    }
+    destravar_se_concorrente(&trava_reservas);
+    vista->referencias++;                  // Referência deste leitor
+    destravar_se_concorrente(&trava_vista);
+    return vista;
+}
+
+void vista_reservas_soltar(VistaReservas *vista) { // Devolve a vista; a última referência libera a cópia
+    travar_se_concorrente(&trava_vista);
+    int restantes = --vista->referencias;
+    destravar_se_concorrente(&trava_vista);
+    if (restantes == 0) {
+        tabela_reservas_liberar(&vista->ativas);
+        free(vista);
+    }
+}
+
+typedef struct {                        // Reserva da vista com seu ID (ordenação da listagem)
+    int id_reserva;
+    int posicao;                         // Posição na cópia do conjunto ativo
+} PosicaoPorId;
+
+typedef struct {                        // Contexto da formatação paralela da listagem de ativas
+    TextoBloco *textos;                  // Um texto por bloco
+    const TabelaReservas *ativas;        // Conjunto ativo da vista
+    const PosicaoPorId *ordem;           // Posições em 'ativas', em ordem de ID
+} ListagemAtivas;
+
+int comparar_posicoes_por_id(const void *a, const void *b) { // Ordena posições do conjunto ativo pelo ID (qsort)
+    int x = ((const PosicaoPorId *)a)->id_reserva;
+    int y = ((const PosicaoPorId *)b)->id_reserva;
+    return (x > y) - (x < y);
+}
+
+void formatar_reservas_ativas(int inicio, int fim, int bloco, void *contexto) { // Formata as ativas [inicio, fim) da ordem por ID
+    const ListagemAtivas *listagem = (const ListagemAtivas *)contexto;
+    const TabelaReservas *ativas = listagem->ativas;
+    TextoBloco *texto = &listagem->textos[bloco]; // Cada bloco escreve no seu próprio texto
+    char checkin_str[TAM_DATA], checkout_str[TAM_DATA]; // Datas formatadas só para exibição
+    for (int k = inicio; k < fim; k++) {  // O conjunto ativo só tem reservas ATIVA: nada a filtrar
+        int i = listagem->ordem[k].posicao;
+        formatar_data(ativas->dia_checkin[i], checkin_str);
+        formatar_data(ativas->dia_checkout[i], checkout_str);
+        texto_bloco_printf(texto, "%-7d | %-6d | %-8d | %-10s | %-10s | R$%-8.2f | Ativa\n",
+              ativas->id_reserva[i],       // ID da reserva
+              ativas->numero_quarto[i],    // Número do quarto
+              ativas->id_hospede[i],       // ID do hóspede
+              checkin_str,                        // Check-in
+              checkout_str,                       // Check-out
+              ativas->valor_centavos[i] / 100.0); // Valor total
+    }
+}
+
+void escrever_reservas_ativas(BufferSaida *saida) { // Escreve a lista de reservas ATIVAS, em ordem de ID
+    VistaReservas *vista = vista_reservas_obter(); // Versão consistente: reservas novas não travam nem mudam a listagem
+    int total = vista->num_ativas + vista->num_arquivadas;
+    saida_printf(saida, "\n--- Lista de Reservas Ativas (%d no total) ---\n", total); // Cabeçalho (observação: mostra total de reservas, não só ativas)
+    if (total == 0) {                      // Se não há reservas cadastradas
+        saida_printf(saida, "Nenhuma reserva ativa.\n");
+        vista_reservas_soltar(vista);
+        return;
+    }
+    saida_printf(saida, "ID Res. | Quarto | ID Hosp. | Check-In   | Check-Out  | Valor Total | Status\n");
+    saida_printf(saida, "----------------------------------------------------------------------------------\n");
+
+    // Blocos de reservas formatados em paralelo; os textos são emitidos na ordem dos blocos
+    // O conjunto ativo perde a ordem com as remoções: ordena só as posições ativas (proporcional à ocupação)
+    int num_blocos = planejar_blocos(vista->num_ativas, MIN_RESERVAS_POR_BLOCO);
+    TextoBloco *textos = (TextoBloco *)calloc(num_blocos, sizeof(TextoBloco));
+    PosicaoPorId *ordem = (PosicaoPorId *)malloc((vista->num_ativas + 1) * sizeof(PosicaoPorId));
+    if (textos == NULL || ordem == NULL) {
+        fprintf(stderr, "Erro fatal: Nao foi possivel alocar memoria para a listagem!\n");
+        exit(1);
+    }
+    for (int i = 0; i < vista->num_ativas; i++) {
+        ordem[i].id_reserva = vista->ativas.id_reserva[i];
+        ordem[i].posicao = i;
+    }
+    if (vista->num_ativas > 1) qsort(ordem, vista->num_ativas, sizeof(PosicaoPorId), comparar_posicoes_por_id);
+    ListagemAtivas listagem = {textos, &vista->ativas, ordem};
+    executar_paralelo(vista->num_ativas, num_blocos, formatar_reservas_ativas, &listagem);
+    for (int b = 0; b < num_blocos; b++) {
+        saida_escrever(saida, textos[b].dados, textos[b].usado);
+        free(textos[b].dados);
+    }
+    free(textos);
+    free(ordem);
+    vista_reservas_soltar(vista);
+}
+
+void listar_reservas_ativas() {             // Lista reservas que estão com status ATIVA
+    static BufferSaida saida;              // Estático: buffer grande demais para a pilha
+    saida.arquivo = stdout;
+    saida.usado = 0;
+    escrever_reservas_ativas(&saida);
+    saida_descarregar(&saida);
+}
+
+void adicionar_reserva_ao_historico(int id_hospede, int id_reserva) { // Adiciona ID da reserva ao histórico do hóspede
+    int index = buscar_hospede_por_id(id_hospede); // Índice local do hóspede, pelo índice de IDs
+    if (index == -1) return;               // Se não encontrou hóspede, sai
+
+    Hospede *h = &hospedes_hotel[index];   // Ponteiro para o hóspede encontrado
+
+    travar_se_concorrente(&trava_historicos); // O pool é de todos os hóspedes e as reservas andam em paralelo
+    historico_anexar(h, id_reserva * MAX_HOTEIS + (int)(hotel_atual - hoteis)); // Anexa ID e hotel no último bloco do hóspede
+    destravar_se_concorrente(&trava_historicos);
+}
+
+
+int buscar_reserva_ativa(int id_reserva) { // Posição da reserva ATIVA com esse ID no conjunto ativo, ou -1, em O(1)
+    Hotel *hotel = hotel_atual;
+    int i = indice_id_buscar(hotel->indice_reservas_id, hotel->capacidade_indice_reservas_id, id_reserva);
+    return (i >= 0) ? i : -1;              // No servidor, chamar com trava_reservas (remoções movem reservas)
+}
+
+int buscar_reserva_arquivada(int id_reserva) { // Posição da reserva concluída/cancelada no arquivo, ou -1, em O(1)
+    Hotel *hotel = hotel_atual;
+    int i = indice_id_buscar(hotel->indice_reservas_id, hotel->capacidade_indice_reservas_id, id_reserva);
+    return (i <= -2) ? -2 - i : -1;
+}
+
+void arquivar_reserva(int i) {            // Move a reserva da posição 'i' do conjunto ativo para o fim do arquivo
+    Hotel *hotel = hotel_atual;
+    Reserva reserva;
+    reserva_ler(&hotel->reservas_hotel, i, &reserva);
+    reservar_arquivadas(1);
+    reserva_gravar(&hotel->reservas_arquivadas, hotel->contador_arquivadas, &reserva);
+    indice_reservas_id_definir(reserva.id_reserva, hotel->contador_arquivadas, 1);
+    hotel->contador_arquivadas++;
+    hotel->contador_reservas--;     // Remoção O(1): a última ativa ocupa o lugar da que saiu
+    if (i != hotel->contador_reservas) {
+        Reserva ultima;
+        reserva_ler(&hotel->reservas_hotel, hotel->contador_reservas, &ultima);
+        reserva_gravar(&hotel->reservas_hotel, i, &ultima);
+        indice_reservas_id_definir(ultima.id_reserva, i, 0);
+    }
+}
+
+int registrar_status_reserva(int id_reserva, int novo_status_reserva) { // Cancelamento/conclusão (ver alterar_status_reserva)
+    Hotel *hotel = hotel_atual;
+    if (novo_status_reserva != CANCELADA && novo_status_reserva != CONCLUIDA) { // Só há esses dois destinos
+        return ERRO_PARAMETRO_INVALIDO;
+    }
+    travar_se_concorrente(&trava_reservas);
+    int i = buscar_reserva_ativa(id_reserva); // Localiza a reserva no conjunto ativo
+    int quarto_associado = (i == -1) ? 0 : hotel->reservas_hotel.numero_quarto[i]; // Recupera quarto associado (não muda)
+    destravar_se_concorrente(&trava_reservas);
+    if (i == -1) {                         // Inexistente, ou já cancelada/concluída (está no arquivo)
+        return ERRO_RESERVA_INVALIDA;
+    }
+    int indice_quarto = buscar_quarto_por_numero(quarto_associado);
+    travar_se_concorrente(&hotel->travas_quartos[indice_quarto]); // O status da reserva só muda sob a trava do seu quarto
+    travar_se_concorrente(&trava_reservas); // Outras remoções podem ter movido a reserva: procura de novo
+    i = buscar_reserva_ativa(id_reserva);
+    if (i == -1 || (hotel->contador_arquivadas == hotel->capacidade_arquivadas && !acesso_exclusivo)) {
+        destravar_se_concorrente(&trava_reservas);
+        destravar_se_concorrente(&hotel->travas_quartos[indice_quarto]);
+        return (i == -1) ? ERRO_RESERVA_INVALIDA : ERRO_REPETIR_EXCLUSIVO; // Arquivo cheio: crescer exige acesso exclusivo
+    }
+    int id_hospede = hotel->reservas_hotel.id_hospede[i];
+    long dia_checkin = hotel->reservas_hotel.dia_checkin[i];
+    long dia_checkout = hotel->reservas_hotel.dia_checkout[i];
+    long long valor_centavos = hotel->reservas_hotel.valor_centavos[i];
+    hotel->reservas_hotel.status_reserva[i] = (unsigned char)novo_status_reserva; // Atualiza status da reserva
+    arquivar_reserva(i);                   // Sai do conjunto ativo para o arquivo
+    hotel->versao_reservas++;
+    destravar_se_concorrente(&trava_reservas);
+    adicionar_reserva_ao_historico(id_hospede, id_reserva); // Move reserva para histórico do hóspede
+    if (novo_status_reserva == CANCELADA) { // Reserva cancelada deixa de bloquear o período
+        agenda_remover(indice_quarto, id_reserva);
+        calendario_reserva_removida(indice_quarto, dia_checkin, dia_checkout);
+        analise_registrar(indice_quarto, dia_checkin, dia_checkout, valor_centavos, -1); // Devolve noites e receita
+    }
+    RegistroJournalStatus registro = {id_reserva, novo_status_reserva};
+    journal_registrar(JOURNAL_STATUS_RESERVA, &registro, sizeof(registro)); // Registra a alteração no journal
+    destravar_se_concorrente(&hotel->travas_quartos[indice_quarto]);
+    return OPERACAO_OK;
+}
+
+int alterar_status_reserva(int id_reserva, int novo_status_reserva) { // Núcleo do cancelamento/conclusão (sem prompts)
+    MEDIR_INICIO(MEDIDA_ALTERAR_RESERVA);
+    int codigo = registrar_status_reserva(id_reserva, novo_status_reserva);
+    MEDIR_FIM(MEDIDA_ALTERAR_RESERVA, 1);
+    return codigo;
+}
+
+void gerenciar_reserva(){                  // Função para cancelar ou concluir reservas ativas
+    Hotel *hotel = hotel_atual;
+    int id_reserva_alvo;                   // ID da reserva alvo informado pelo usuário
+    int indice_reserva;                    // Índice da reserva ativa encontrada
+    int sub_opcao = 0;                     // Escolha do usuário (cancelar/concluir)
+    int novo_status_reserva = CANCELADA;   // Novo status a ser aplicado
+
+    printf("\nGERENCIAR RESERVAS ATIVAS\n");
+     if (hotel->contador_reservas == 0) { // Se não há reservas ativas no sistema
+        printf("Nenhuma reserva ativa no sistema.\n");
+        return;
+    }
+    listar_reservas_ativas();              // Mostra reservas ativas para o usuário
+
+    do {
+        printf("\nDigite o ID da reserva alvo (ou 0 para sair): ");
+        scanf("%d", &id_reserva_alvo);     // Lê o ID desejado
+
+        if (id_reserva_alvo == 0) {        // Se usuário cancelar a operação
+            printf("Genciamento cancelado\n");
+            return;
+        }
+        indice_reserva = buscar_reserva_ativa(id_reserva_alvo); // Procura a reserva ativa
+        if (indice_reserva == -1) {        // Se não encontrou reserva válida
+            printf("ERRO: ID de reserva invalido ou reserva inativa. Tente novamente.\n");
+        }
+    } while (indice_reserva == -1);        // Repete até encontrar ou sair
+
+    printf("\nReserva %d encontrada. Escolha a acao:\n", id_reserva_alvo); // Mostra opções
+    printf("1 - CANCELAR reserva (Status: CANCELADA)\n");
+    printf("2 - CONCLUIR reserva (Status: CONCLUIDA / Check-out)\n");
+    do{
+        scanf("%d", &sub_opcao);           // Lê escolha do usuário
+        if (sub_opcao == 1) {
+            novo_status_reserva = CANCELADA; // Define novo status como CANCELADA
+            printf("Reserva %d CANCELADA.\n", id_reserva_alvo);
+        }else if (sub_opcao == 2) {
+            novo_status_reserva = CONCLUIDA; // Define novo status como CONCLUIDA
+            printf("Reserva %d CONCLUIDA (Check-out).\n", id_reserva_alvo);
+        } else {
+            printf("Opcao invalida. Digite novamente\n");
+        }
+    }while(sub_opcao != 1 && sub_opcao != 2);
+
+    int quarto_associado = hotel->reservas_hotel.numero_quarto[indice_reserva]; // Recupera quarto associado
+    alterar_status_reserva(id_reserva_alvo, novo_status_reserva); // Aplica o novo status (cancelada libera as noites)
+    if (novo_status_reserva == CANCELADA) {
+        printf("Periodo da reserva liberado no quarto %d.\n", quarto_associado);
+    } else {
+        printf("Check-out registrado no quarto %d.\n", quarto_associado);
+    }
+}
+
+const char *descrever_status_reserva(int status) { // Nome do status para exibição
+    switch (status) {
+        case ATIVA: return "Ativa";
+        case CONCLUIDA: return "Concluida";
+        case CANCELADA: return "Cancelada";
+        default: return "?";
+    }
+}
+
+typedef struct {                        // Contexto da busca paralela das reservas de um histórico na rede
+    const int *entradas;                 // Entradas do histórico: ID * MAX_HOTEIS + hotel
+    int quantidade;
+    Reserva *reservas;                   // Saída: reservas[i] da entrada i (id_reserva = -1 se não achou)
+} ConsultaHistorico;
+
+void resolver_historico(int inicio, int fim, int bloco, void *contexto) { // Reservas do histórico dos hotéis [inicio, fim)
+    ConsultaHistorico *consulta = (ConsultaHistorico *)contexto;
+    Hotel *anterior = hotel_atual;         // A chamadora também executa blocos: devolve o seu hotel no fim
+    (void)bloco;
+    for (int h = inicio; h < fim; h++) {
+        hotel_atual = &hoteis[h];
+        for (int i = 0; i < consulta->quantidade; i++) { // Só as entradas deste hotel
+            if (consulta->entradas[i] % MAX_HOTEIS != h) continue;
+            int r = buscar_reserva_arquivada(consulta->entradas[i] / MAX_HOTEIS); // Histórico = reservas arquivadas
+            if (r == -1) {
+                consulta->reservas[i].id_reserva = -1;
+            } else {
+                reserva_ler(&hoteis[h].reservas_arquivadas, r, &consulta->reservas[i]);
+            }
+        }
+    }
+    hotel_atual = anterior;
+}
+
+void escrever_historico(BufferSaida *saida, int index) { // Escreve o histórico do hóspede de índice 'index' (toda a rede)
+    Hospede *h = &hospedes_hotel[index];   // Ponteiro para o hóspede
+    char cpf[TAM_CPF];                     // CPF decodificado para exibição
+
+    saida_printf(saida, "\nHistorico de Reservas de %s (CPF %s)\n",
+                 nome_hospede(h), texto_cpf(h->cpf, cpf)); // Cabeçalho com nome e CPF
+
+    if (h->num_reservas_historico == 0) {  // Se não há histórico
+        saida_printf(saida, "Nenhuma reserva concluida/cancelada ainda.\n");
+        return;
+    }
+
+    int quantidade = h->num_reservas_historico;
+    int *entradas = (int *)malloc(quantidade * sizeof(int)); // Entradas do pool, em ordem
+    Reserva *reservas = (Reserva *)malloc(quantidade * sizeof(Reserva)); // Detalhes de cada entrada
+    if (entradas == NULL || reservas == NULL) {
+        fprintf(stderr, "Erro fatal: Nao foi possivel alocar memoria para o historico!\n");
+        exit(1);
+    }
+    historico_copiar(h, entradas);
+    for (int i = 0; i < quantidade; i++) reservas[i].id_reserva = -1; // Entrada de hotel inexistente fica sem detalhes
+    ConsultaHistorico consulta = {entradas, quantidade, reservas};
+    executar_paralelo(num_hoteis, num_hoteis, resolver_historico, &consulta); // Cada hotel busca as suas reservas
+
+    char checkin_str[TAM_DATA], checkout_str[TAM_DATA]; // Datas formatadas só para exibição
+    for (int i = 0; i < quantidade; i++) { // Na ordem do histórico, qualquer que seja o hotel
+        int id = entradas[i] / MAX_HOTEIS;
+        saida_printf(saida, "- Reserva ID %d", id);
+        if (num_hoteis > 1) saida_printf(saida, " | Hotel %d", entradas[i] % MAX_HOTEIS + 1); // Só numa rede
+        if (reservas[i].id_reserva == -1) {
+            saida_printf(saida, "\n");
+            continue;
+        }
+        formatar_data(reservas[i].dia_checkin, checkin_str);
+        formatar_data(reservas[i].dia_checkout, checkout_str);
+        saida_printf(saida, " | Quarto %d | %s a %s | R$%.2f | %s\n",
+                     reservas[i].numero_quarto, checkin_str, checkout_str, reservas[i].valor_centavos / 100.0,
+                     descrever_status_reserva(reservas[i].status_reserva));
+    }
+    free(entradas);
+    free(reservas);
+}
 
 void mostrar_historico() {                 // Mostra histórico de reservas de um hóspede
+    static BufferSaida saida;              // Estático: buffer grande demais para a pilha
     char cpf[TAM_CPF];                     // Buffer para CPF digitado
     printf("Digite o CPF do hospede: ");
     scanf("%s", cpf);                      // Lê CPF
 
-    int index = buscar_hospede_por_cpf(cpf); // Busca índice do hóspede
-    if (index == -1) {                     // Se não encontrado
-        printf("Hospede nao encontrado.\n");
+    int index = buscar_hospede_por_cpf(cpf); // Busca índice do hóspede
+    if (index == -1) {                     // Se não encontrado
+        printf("Hospede nao encontrado.\n");
+        return;
+    }
+
+    saida.arquivo = stdout;
+    saida.usado = 0;
+    escrever_historico(&saida, index);     // Monta o texto no buffer e escreve de uma vez
+    saida_descarregar(&saida);
+}
+
+int quarto_disponivel_periodo(int numero_quarto, const char* data_in, const char* data_out)
+{                                         // Retorna 1 se quarto estiver disponível no período, 0 caso contrário
+    int indice = buscar_quarto_por_numero(numero_quarto); // Localiza a agenda do quarto
+    if (indice == -1) {                   // Quarto inexistente não tem reservas que bloqueiem
+        return 1;
+    }
+    // Reservas canceladas são retiradas da agenda, então só as que bloqueiam são consultadas
+    return quarto_disponivel_indice(indice, converter_data_em_dias(data_in), converter_data_em_dias(data_out));
+}
+
+
+typedef struct {                        // Contexto da avaliação paralela de disponibilidade pelas agendas
+    long dia_in;
+    long dia_out;
+    unsigned char *marcas;               // Saída: uma marca por quarto
+} ConsultaPeriodo;
+
+void avaliar_quartos_periodo(int inicio, int fim, int bloco, void *contexto) { // Avalia os quartos [inicio, fim)
+    ConsultaPeriodo *consulta = (ConsultaPeriodo *)contexto;
+    (void)bloco;
+    for (int i = inicio; i < fim; i++) {
+        consulta->marcas[i] = (unsigned char)quarto_livre_periodo(i, consulta->dia_in, consulta->dia_out); // Já medido como lista
+    }
+}
+
+int consultar_quartos_livres(long dia_in, long dia_out, int *indices) { // Quartos livres no período (ver coletar_quartos_disponiveis)
+    Hotel *hotel = hotel_atual;
+    travar_se_concorrente(&trava_calendario);
+    if (acesso_exclusivo) {
+        calendario_preparar();             // Refazer percorre todas as agendas: só com acesso exclusivo
+    }
+    if (calendario_atualizado() && calendario_cobre(dia_in, dia_out)) { // Período dentro da janela: responde pelos bitmaps
+        int quantidade = calendario_coletar_livres(dia_in, dia_out, indices);
+        destravar_se_concorrente(&trava_calendario);
+        return quantidade;
+    }
+    destravar_se_concorrente(&trava_calendario);
+    if (!acesso_exclusivo) {
+        return -1;
+    }
+    // Fora da janela: cada bloco avalia as agendas de uma faixa de quartos e marca os livres
+    hotel->marcas_livres = (unsigned char *)crescer_vetor(hotel->marcas_livres, &hotel->capacidade_marcas_livres,
+                                                          hotel->contador_quartos + 1, 1, "consulta de disponibilidade");
+    unsigned char *marcas = hotel->marcas_livres; // Do hotel: consultas da rede avaliam hotéis em paralelo
+    ConsultaPeriodo consulta = {dia_in, dia_out, marcas};
+    executar_paralelo(hotel->contador_quartos, planejar_blocos(hotel->contador_quartos, MIN_QUARTOS_POR_BLOCO),
+                      avaliar_quartos_periodo, &consulta);
+    int quantidade = 0;                    // 'indices' deve ter espaço para contador_quartos posições
+    for (int i = 0; i < hotel->contador_quartos; i++) { // Junta o resultado em ordem de cadastro
+        if (marcas[i]) {
+            indices[quantidade++] = i;
+        }
+    }
+    return quantidade;
+}
+
+int coletar_quartos_disponiveis(long dia_in, long dia_out, int *indices) { // Preenche 'indices' com os quartos livres no período
+    // Retorna a quantidade, ou -1 se a consulta precisa de acesso exclusivo (servidor: calendário a refazer ou período fora da janela)
+    MEDIR_INICIO(MEDIDA_QUARTOS_DISPONIVEIS);
+    int quantidade = consultar_quartos_livres(dia_in, dia_out, indices);
+    MEDIR_FIM(MEDIDA_QUARTOS_DISPONIVEIS, quantidade < 0 ? 0 : hotel_atual->contador_quartos); // Quartos avaliados
+    return quantidade;
+}
+
+typedef struct {                        // Contexto da cotação paralela (uma oferta por quarto livre)
+    const int *indices;                  // Quartos livres
+    const int *percentuais;              // Linha de 'noites' percentuais por tipo de quarto
+    const unsigned char *preco_cheio;    // preco_cheio[t] = 1 se nenhuma regra altera o tipo t no período
+    int noites;
+    Oferta *ofertas;                     // Saída: ofertas[k] para indices[k]
+} ConsultaCotacao;
+
+void cotar_quartos(int inicio, int fim, int bloco, void *contexto) { // Valor da estadia para os quartos livres [inicio, fim)
+    Hotel *hotel = hotel_atual;
+    const ConsultaCotacao *consulta = (const ConsultaCotacao *)contexto;
+    (void)bloco;
+    for (int k = inicio; k < fim; k++) {
+        int i = consulta->indices[k];
+        int id_tipo = hotel->tipos_dos_quartos[i];
+        long long base = centavos_de_preco(hotel->quartos_hotel[i].preco_diaria);
+        long long total = 0;
+        if (consulta->preco_cheio[id_tipo]) { // Nenhuma regra no período: diária fixa
+            total = base * consulta->noites;
+        } else {
+            const int *percentuais = consulta->percentuais + (size_t)id_tipo * consulta->noites;
+            for (int d = 0; d < consulta->noites; d++) { // Laço simples sobre inteiros: vetorizável
+                total += (base * percentuais[d] + 50) / 100;
+            }
+        }
+        consulta->ofertas[k].indice_quarto = i;
+        consulta->ofertas[k].total_centavos = total;
+    }
+}
+
+int comparar_ofertas(const void *a, const void *b) { // Mais barata primeiro; empate pelo número do quarto (qsort)
+    Hotel *hotel = hotel_atual;
+    const Oferta *x = (const Oferta *)a, *y = (const Oferta *)b;
+    if (x->total_centavos != y->total_centavos) return (x->total_centavos < y->total_centavos) ? -1 : 1;
+    return (hotel->quartos_hotel[x->indice_quarto].numero > hotel->quartos_hotel[y->indice_quarto].numero) -
+           (hotel->quartos_hotel[x->indice_quarto].numero < hotel->quartos_hotel[y->indice_quarto].numero);
+}
+
+int cotar_estadia(long dia_in, long dia_out, Oferta *ofertas) { // Ofertas de todos os quartos livres, da mais barata à mais cara
+    Hotel *hotel = hotel_atual;
+    // 'ofertas' deve ter espaço para contador_quartos posições; retorna a quantidade, ou -1 como coletar_quartos_disponiveis
+    int *indices = (int *)malloc((hotel->contador_quartos + 1) * sizeof(int)); // +1: evita malloc(0)
+    if (indices == NULL) {                 // Verifica falha de alocação
+        fprintf(stderr, "Erro fatal: Nao foi possivel alocar memoria para a cotacao!\n");
+        exit(1);
+    }
+    int encontrados = coletar_quartos_disponiveis(dia_in, dia_out, indices);
+    if (encontrados <= 0) {
+        free(indices);
+        return encontrados;
+    }
+    // Regras resolvidas uma vez por tipo e noite; depois cada quarto só soma inteiros
+    int noites = (int)(dia_out - dia_in);
+    int *percentuais = (int *)malloc((size_t)hotel->contador_tipos * noites * sizeof(int));
+    unsigned char *preco_cheio = (unsigned char *)malloc(hotel->contador_tipos);
+    if (percentuais == NULL || preco_cheio == NULL) {
+        fprintf(stderr, "Erro fatal: Nao foi possivel alocar memoria para a cotacao!\n");
+        exit(1);
+    }
+    for (int t = 0; t < hotel->contador_tipos; t++) {
+        preco_cheio[t] = 1;
+        for (int d = 0; d < noites; d++) {
+            int percentual = (hotel->contador_regras == 0) ? 100 : percentual_da_noite(hotel->tipos_quarto[t], dia_in + d);
+            percentuais[(size_t)t * noites + d] = percentual;
+            if (percentual != 100) preco_cheio[t] = 0;
+        }
+    }
+    ConsultaCotacao consulta = {indices, percentuais, preco_cheio, noites, ofertas};
+    executar_paralelo(encontrados, planejar_blocos(encontrados, MIN_QUARTOS_POR_BLOCO), cotar_quartos, &consulta);
+    qsort(ofertas, encontrados, sizeof(Oferta), comparar_ofertas);
+    free(indices);
+    free(percentuais);
+    free(preco_cheio);
+    return encontrados;
+}
+
+void cotar_estadia_menu() {                // Cota todos os quartos livres para um período, do mais barato ao mais caro
+    Hotel *hotel = hotel_atual;
+    if (hotel->contador_quartos == 0) { // Se nenhum quarto cadastrado
+        printf("Nenhum quarto cadastrado.\n");
+        return;
+    }
+    char data_in[TAM_DATA];                // Buffer para data de check-in
+    char data_out[TAM_DATA];               // Buffer para data de check-out
+    printf("Digite a data de Check-in (DD/MM/AAAA): ");
+    scanf("%s", data_in);
+    printf("Digite a data de Check-out (DD/MM/AAAA): ");
+    scanf("%s", data_out);
+    long dia_in = converter_data_em_dias(data_in);
+    long dia_out = converter_data_em_dias(data_out);
+    if (dia_in == DATA_INVALIDA || dia_out == DATA_INVALIDA || dia_out <= dia_in) { // Período vazio ou mal formado
+        printf("Periodo invalido. Use o formato DD/MM/AAAA e um check-out posterior ao check-in.\n");
+        return;
+    }
+
+    Oferta *ofertas = (Oferta *)malloc(hotel->contador_quartos * sizeof(Oferta));
+    if (ofertas == NULL) {                 // Verifica falha de alocação
+        printf("Erro fatal: Nao foi possivel alocar memoria para a cotacao!\n");
+        exit(1);
+    }
+    int encontrados = cotar_estadia(dia_in, dia_out, ofertas);
+    printf("\n--- COTACAO DE %s A %s (%ld noites) ---\n", data_in, data_out, dia_out - dia_in);
+    for (int k = 0; k < encontrados; k++) { // Do mais barato ao mais caro
+        const Quarto *quarto = &hotel->quartos_hotel[ofertas[k].indice_quarto];
+        printf("Quarto %d (%s) - R$ %.2f\n", quarto->numero, quarto->tipo, ofertas[k].total_centavos / 100.0);
+    }
+    if (encontrados == 0) {
+        printf("Nenhum quarto disponível para esse período.\n");
+    }
+    free(ofertas);
+}
+
+void mais_baratos_menu() {                 // Os k quartos livres mais baratos de um tipo em um período
+    Hotel *hotel = hotel_atual;
+    char tipo[TAM_TIPO];                   // Tipo procurado
+    char data_in[TAM_DATA];                // Buffer para data de check-in
+    char data_out[TAM_DATA];               // Buffer para data de check-out
+    int k = 0;                             // Quantos quartos mostrar
+    printf("Digite o tipo do quarto: ");
+    scanf("%19s", tipo);
+    printf("Digite a data de Check-in (DD/MM/AAAA): ");
+    scanf("%s", data_in);
+    printf("Digite a data de Check-out (DD/MM/AAAA): ");
+    scanf("%s", data_out);
+    printf("Quantos quartos mostrar: ");
+    scanf("%d", &k);
+    long dia_in = converter_data_em_dias(data_in);
+    long dia_out = converter_data_em_dias(data_out);
+    if (dia_in == DATA_INVALIDA || dia_out == DATA_INVALIDA || dia_out <= dia_in) { // Período vazio ou mal formado
+        printf("Periodo invalido. Use o formato DD/MM/AAAA e um check-out posterior ao check-in.\n");
+        return;
+    }
+    if (k <= 0) {
+        printf("Quantidade invalida.\n");
+        return;
+    }
+    if (k > hotel->contador_quartos) k = hotel->contador_quartos;
+
+    Oferta *ofertas = (Oferta *)malloc((k + 1) * sizeof(Oferta)); // +1: evita malloc(0)
+    if (ofertas == NULL) {                 // Verifica falha de alocação
+        printf("Erro fatal: Nao foi possivel alocar memoria para a busca!\n");
+        exit(1);
+    }
+    int encontrados = buscar_mais_baratos(buscar_tipo_quarto(tipo), dia_in, dia_out, k, ofertas);
+    printf("\n--- %s MAIS BARATOS DE %s A %s ---\n", tipo, data_in, data_out);
+    for (int n = 0; n < encontrados; n++) { // Do mais barato ao mais caro
+        const Quarto *quarto = &hotel->quartos_hotel[ofertas[n].indice_quarto];
+        printf("Quarto %d - R$ %.2f / dia - R$ %.2f no periodo\n", quarto->numero, quarto->preco_diaria,
+               ofertas[n].total_centavos / 100.0);
+    }
+    if (encontrados == 0) {
+        printf("Nenhum quarto desse tipo disponível para esse período.\n");
+    }
+    free(ofertas);
+}
+
+void listar_quartos_disponiveis_periodo()
+{                                         // Lista quartos que estão livres para um período informado
+    Hotel *hotel = hotel_atual;
+    if (hotel->contador_quartos == 0) { // Se nenhum quarto cadastrado
+        printf("Nenhum quarto cadastrado.\n");
+        return;
+    }
+
+    char data_in[TAM_DATA];                // Buffer para data de check-in
+    char data_out[TAM_DATA];               // Buffer para data de check-out
+
+    printf("Digite a data de Check-in (DD/MM/AAAA): ");
+    scanf("%s", data_in);                  // Lê check-in
+
+    printf("Digite a data de Check-out (DD/MM/AAAA): ");
+    scanf("%s", data_out);                 // Lê check-out
+
+    long dia_in = converter_data_em_dias(data_in);   // Converte o período uma única vez
+    long dia_out = converter_data_em_dias(data_out);
+    if (dia_in == DATA_INVALIDA || dia_out == DATA_INVALIDA) { // Datas mal formadas
+        printf("Data invalida. Use o formato DD/MM/AAAA.\n");
+        return;
+    }
+
+    printf("\n--- QUARTOS DISPONIVEIS DE %s A %s ---\n", data_in, data_out); // Cabeçalho mostrando período
+
+    int *indices = (int *)malloc(hotel->contador_quartos * sizeof(int)); // Quartos livres encontrados
+    if (indices == NULL) {                 // Verifica falha de alocação
+        printf("Erro fatal: Nao foi possivel alocar memoria para a consulta!\n");
+        exit(1);
+    }
+    int encontrados = coletar_quartos_disponiveis(dia_in, dia_out, indices);
+    for (int k = 0; k < encontrados; k++) { // Exibe cada quarto disponível
+        int i = indices[k];
+        printf("Quarto %d (%s) - R$ %.2f / dia\n",
+               hotel->quartos_hotel[i].numero, // Número do quarto
+               hotel->quartos_hotel[i].tipo, // Tipo do quarto
+               hotel->quartos_hotel[i].preco_diaria); // Preço por dia
+    }
+    free(indices);
+
+    if (encontrados == 0) {                // Se não encontrou nenhum quarto disponível
+        printf("Nenhum quarto disponível para esse período.\n");
+    }
+}
+
+//MANUTENCAO POR PERIODO E STATUS POR DATA
+// O status guardado no quarto é o do cadastro: LIVRE = em operação; OCUPADO/MANUTENCAO = fora de operação por
+// tempo indeterminado. Reservas não mexem nele: a ocupação de cada noite vem da agenda (status_quarto_em),
+// onde reservas ativas e concluídas ocupam e a manutenção é um intervalo próprio com id BLOQUEIO_MANUTENCAO.
+// Uma reserva futura não bloqueia o quarto em outras datas, e calendário, consultas de disponibilidade e
+// criação de reservas enxergam os bloqueios sem caso especial.
+int bloquear_manutencao(int numero_quarto, long inicio, long fim) { // Bloqueia as noites [inicio, fim) do quarto
+    Hotel *hotel = hotel_atual;
+    int indice_quarto = buscar_quarto_por_numero(numero_quarto);
+    if (indice_quarto == -1) {
+        return ERRO_QUARTO_INEXISTENTE;
+    }
+    if (inicio == DATA_INVALIDA || fim == DATA_INVALIDA || fim <= inicio) {
+        return ERRO_DATAS_INVALIDAS;
+    }
+    travar_se_concorrente(&hotel->travas_quartos[indice_quarto]); // Conferência e bloqueio numa só etapa
+    if (!quarto_livre_periodo(indice_quarto, inicio, fim)) { // Reserva ou outro bloqueio no período
+        destravar_se_concorrente(&hotel->travas_quartos[indice_quarto]);
+        return ERRO_QUARTO_INDISPONIVEL;
+    }
+    agenda_inserir(indice_quarto, inicio, fim, BLOQUEIO_MANUTENCAO);
+    calendario_reserva_criada(indice_quarto, inicio, fim); // Noites bloqueadas saem das consultas de disponibilidade
+    BloqueioManutencao registro;
+    memset(&registro, 0, sizeof(registro)); // Zera o preenchimento (verificação do journal)
+    registro.numero_quarto = numero_quarto;
+    registro.inicio = inicio;
+    registro.fim = fim;
+    journal_registrar(JOURNAL_MANUTENCAO, &registro, sizeof(registro));
+    destravar_se_concorrente(&hotel->travas_quartos[indice_quarto]);
+    return OPERACAO_OK;
+}
+
+int liberar_manutencao(int numero_quarto, long inicio, long fim) { // Desfaz o bloqueio [inicio, fim) do quarto
+    Hotel *hotel = hotel_atual;
+    int indice_quarto = buscar_quarto_por_numero(numero_quarto);
+    if (indice_quarto == -1) {
+        return ERRO_QUARTO_INEXISTENTE;
+    }
+    if (inicio == DATA_INVALIDA || fim == DATA_INVALIDA || fim <= inicio) {
+        return ERRO_DATAS_INVALIDAS;
+    }
+    travar_se_concorrente(&hotel->travas_quartos[indice_quarto]);
+    AgendaQuarto *agenda = &hotel->agendas_quartos[indice_quarto];
+    int k = agenda_contar_antes(agenda, inicio); // Primeiro intervalo com checkin >= inicio
+    for (; k < agenda->num_intervalos && agenda->intervalos[k].checkin == inicio; k++) {
+        if (agenda->intervalos[k].id_reserva == BLOQUEIO_MANUTENCAO && agenda->intervalos[k].checkout == fim) break;
+    }
+    if (k == agenda->num_intervalos || agenda->intervalos[k].checkin != inicio) { // Precisa ser um bloqueio exato
+        destravar_se_concorrente(&hotel->travas_quartos[indice_quarto]);
+        return ERRO_PARAMETRO_INVALIDO;
+    }
+    agenda_remover_posicao(agenda, k);
+    calendario_reserva_removida(indice_quarto, inicio, fim);
+    BloqueioManutencao registro;
+    memset(&registro, 0, sizeof(registro));
+    registro.numero_quarto = numero_quarto;
+    registro.inicio = inicio;
+    registro.fim = fim;
+    journal_registrar(JOURNAL_FIM_MANUTENCAO, &registro, sizeof(registro));
+    destravar_se_concorrente(&hotel->travas_quartos[indice_quarto]);
+    return OPERACAO_OK;
+}
+
+int consultar_status_quarto(int numero_quarto, long dia, int *status) { // Status derivado do quarto na noite 'dia'
+    Hotel *hotel = hotel_atual;
+    int indice_quarto = buscar_quarto_por_numero(numero_quarto);
+    if (indice_quarto == -1) {
+        return ERRO_QUARTO_INEXISTENTE;
+    }
+    if (dia == DATA_INVALIDA) {
+        return ERRO_DATAS_INVALIDAS;
+    }
+    travar_se_concorrente(&hotel->travas_quartos[indice_quarto]); // A agenda do quarto muda sob a trava dele
+    *status = status_quarto_em(indice_quarto, dia);
+    destravar_se_concorrente(&hotel->travas_quartos[indice_quarto]);
+    return OPERACAO_OK;
+}
+
+void manutencao_quarto_menu() {           // Bloqueia ou libera um quarto para manutenção em um período
+    int numero_quarto, opcao;
+    char inicio_str[TAM_DATA], fim_str[TAM_DATA];
+    printf("\nMANUTENCAO DE QUARTO POR PERIODO\n");
+    printf("Digite o numero do quarto: ");
+    scanf("%d", &numero_quarto);
+    printf("1 - Bloquear para manutencao\n2 - Liberar bloqueio\n");
+    scanf("%d", &opcao);
+    if (opcao != 1 && opcao != 2) {
+        printf("Opcao invalida.\n");
+        return;
+    }
+    printf("Digite a data da primeira noite (DD/MM/AAAA): ");
+    scanf("%s", inicio_str);
+    printf("Digite a data de fim, como um check-out (DD/MM/AAAA): ");
+    scanf("%s", fim_str);
+    long inicio = converter_data_em_dias(inicio_str);
+    long fim = converter_data_em_dias(fim_str);
+    int codigo = (opcao == 1) ? bloquear_manutencao(numero_quarto, inicio, fim) : liberar_manutencao(numero_quarto, inicio, fim);
+    if (codigo != OPERACAO_OK) {
+        printf("ERRO: %s.\n", descrever_erro(codigo));
+        return;
+    }
+    printf("Quarto %d %s de %s a %s.\n", numero_quarto, (opcao == 1) ? "bloqueado para manutencao" : "liberado",
+           inicio_str, fim_str);
+}
+
+void status_quartos_menu() {              // Lista os quartos com o status de uma data
+    char data_str[TAM_DATA];
+    printf("\nSTATUS DOS QUARTOS EM UMA DATA\n");
+    printf("Digite a data (DD/MM/AAAA): ");
+    scanf("%s", data_str);
+    long dia = converter_data_em_dias(data_str);
+    if (dia == DATA_INVALIDA) {
+        printf("ERRO: Data invalida. Use o formato DD/MM/AAAA.\n");
+        return;
+    }
+    listar_quartos_em(dia);
+}
+
+//REDE DE HOTEIS
+// Cada hotel da rede é um shard independente (struct Hotel): quartos, reservas, agendas, calendário,
+// tarifas e agregados. Hóspedes, seus índices e históricos, journal e instrumentação são da rede inteira.
+// As funções do núcleo operam sobre hotel_atual, que é por thread: HOTEL <n> troca o hotel do menu, do
+// lote ou da conexão do servidor, e as trabalhadoras do pool recebem o da thread que publicou a tarefa.
+// IDs de reserva são por hotel; o histórico do hóspede guarda ID * MAX_HOTEIS + hotel.
+// Consultas da rede distribuem os hotéis entre os blocos do pool e juntam os resultados na ordem dos hotéis.
+int selecionar_hotel(int numero) {         // Torna o hotel 'numero' (1..MAX_HOTEIS) o atual, criando-o se for novo
+    if (numero < 1 || numero > MAX_HOTEIS) {
+        return ERRO_PARAMETRO_INVALIDO;
+    }
+    if (numero > num_hoteis) {             // Hotel novo (vazio): muda a rede, só com acesso exclusivo
+        if (!acesso_exclusivo) return ERRO_REPETIR_EXCLUSIVO;
+        num_hoteis = numero;
+    }
+    hotel_atual = &hoteis[numero - 1];
+    return OPERACAO_OK;
+}
+
+int total_quartos_rede() {                 // Quartos de todos os hotéis
+    int total = 0;
+    for (int h = 0; h < num_hoteis; h++) total += hoteis[h].contador_quartos;
+    return total;
+}
+
+int total_reservas_rede() {                // Reservas (ativas e arquivadas) de todos os hotéis
+    int total = 0;
+    for (int h = 0; h < num_hoteis; h++) total += hoteis[h].contador_reservas + hoteis[h].contador_arquivadas;
+    return total;
+}
+
+int total_regras_rede() {                  // Regras de tarifa de todos os hotéis
+    int total = 0;
+    for (int h = 0; h < num_hoteis; h++) total += hoteis[h].contador_regras;
+    return total;
+}
+
+typedef struct {                        // Contexto da disponibilidade na rede (um hotel por vez em cada bloco)
+    long dia_in;
+    long dia_out;
+    int *indices;                        // Saída: quartos livres do hotel h a partir de indices[primeiros[h]]
+    const int *primeiros;
+    int *quantidades;                    // Saída: quartos livres de cada hotel, ou -1 (precisa de acesso exclusivo)
+} ConsultaRede;
+
+void consultar_hoteis_periodo(int inicio, int fim, int bloco, void *contexto) { // Quartos livres dos hotéis [inicio, fim)
+    ConsultaRede *consulta = (ConsultaRede *)contexto;
+    Hotel *anterior = hotel_atual;         // A chamadora também executa blocos: devolve o seu hotel no fim
+    (void)bloco;
+    for (int h = inicio; h < fim; h++) {
+        hotel_atual = &hoteis[h];
+        consulta->quantidades[h] = consultar_quartos_livres(consulta->dia_in, consulta->dia_out,
+                                                            consulta->indices + consulta->primeiros[h]);
+    }
+    hotel_atual = anterior;
+}
+
+int coletar_disponiveis_rede(long dia_in, long dia_out, int *indices, int *primeiros, int *quantidades) {
+    // Quartos livres no período em todos os hotéis: os do hotel h ficam em indices[primeiros[h] .. + quantidades[h]).
+    // 'indices' deve ter total_quartos_rede() posições. Retorna o total, ou -1 se precisa de acesso exclusivo
+    MEDIR_INICIO(MEDIDA_QUARTOS_DISPONIVEIS);
+    int total = 0;
+    for (int h = 0; h < num_hoteis; h++) { // Cada hotel escreve na sua faixa de 'indices'
+        primeiros[h] = total;
+        total += hoteis[h].contador_quartos;
+    }
+    ConsultaRede consulta = {dia_in, dia_out, indices, primeiros, quantidades};
+    executar_paralelo(num_hoteis, num_hoteis, consultar_hoteis_periodo, &consulta); // Um bloco por hotel
+    int encontrados = 0;
+    for (int h = 0; h < num_hoteis; h++) {
+        if (quantidades[h] < 0) {
+            encontrados = -1;
+            break;
+        }
+        encontrados += quantidades[h];
+    }
+    MEDIR_FIM(MEDIDA_QUARTOS_DISPONIVEIS, encontrados < 0 ? 0 : total); // Quartos avaliados
+    return encontrados;
+}
+
+void listar_disponiveis_rede_menu() {      // Opção de menu: quartos livres em todos os hotéis da rede
+    char data_in[TAM_DATA], data_out[TAM_DATA];
+    int primeiros[MAX_HOTEIS], quantidades[MAX_HOTEIS];
+
+    printf("Digite a data de Check-in (DD/MM/AAAA): ");
+    scanf("%10s", data_in);
+    printf("Digite a data de Check-out (DD/MM/AAAA): ");
+    scanf("%10s", data_out);
+    long dia_in = converter_data_em_dias(data_in);
+    long dia_out = converter_data_em_dias(data_out);
+    if (dia_in == DATA_INVALIDA || dia_out == DATA_INVALIDA || dia_out <= dia_in) {
+        printf("Datas invalidas.\n");
+        return;
+    }
+
+    int *indices = (int *)malloc((total_quartos_rede() + 1) * sizeof(int)); // +1: evita malloc(0)
+    if (indices == NULL) {                 // Verifica falha de alocação
+        printf("Erro fatal: Nao foi possivel alocar memoria para a consulta!\n");
+        exit(1);
+    }
+    int encontrados = coletar_disponiveis_rede(dia_in, dia_out, indices, primeiros, quantidades);
+    printf("\n--- QUARTOS DISPONIVEIS NA REDE DE %s A %s ---\n", data_in, data_out);
+    for (int h = 0; h < num_hoteis; h++) { // Hotel a hotel, em ordem de cadastro dos quartos
+        printf("Hotel %d: %d quarto(s) livre(s)\n", h + 1, quantidades[h]);
+        for (int k = 0; k < quantidades[h]; k++) {
+            const Quarto *q = &hoteis[h].quartos_hotel[indices[primeiros[h] + k]];
+            printf("  Quarto %d (%s) - R$ %.2f / dia\n", q->numero, q->tipo, q->preco_diaria);
+        }
+    }
+    printf("Total na rede: %d quarto(s) livre(s)\n", encontrados);
+    free(indices);
+}
+
+void selecionar_hotel_menu() {             // Opção de menu: troca o hotel sobre o qual as demais opções operam
+    int numero;
+    printf("Hotel atual: %d (rede com %d hotel(is)).\n", (int)(hotel_atual - hoteis) + 1, num_hoteis);
+    printf("Digite o numero do hotel (1 a %d; um numero novo cria o hotel): ", MAX_HOTEIS);
+    if (scanf("%d", &numero) != 1 || selecionar_hotel(numero) != OPERACAO_OK) {
+        printf("Numero de hotel invalido.\n");
+        return;
+    }
+    printf("Hotel %d selecionado: %d quartos, %d reservas.\n", numero, hotel_atual->contador_quartos, total_reservas());
+}
+
+void mostrar_medidas() {                   // Opção de menu: contadores e histogramas da instrumentação
+    static BufferSaida saida;              // Estático: buffer grande demais para a pilha
+    saida.arquivo = stdout;
+    saida.usado = 0;
+    escrever_medidas(&saida);
+    saida_descarregar(&saida);
+}
+
+void relatorio_ocupacao() {                // Relatório de ocupação e receita (por período ou mês a mês)
+    static BufferSaida saida;              // Estático: buffer grande demais para a pilha
+    int tipo_relatorio = 0;                // 1 = período, 2 = mensal
+    printf("1 - Por periodo\n");
+    printf("2 - Mensal (um ano)\n");
+    printf("Escolha uma opcao: ");
+    scanf("%d", &tipo_relatorio);          // Lê o tipo de relatório
+
+    saida.arquivo = stdout;
+    saida.usado = 0;
+    if (tipo_relatorio == 1) {
+        char data_in[TAM_DATA];            // Buffer para data inicial
+        char data_out[TAM_DATA];           // Buffer para data final
+        printf("Digite a data inicial (DD/MM/AAAA): ");
+        scanf("%s", data_in);
+        printf("Digite a data final (DD/MM/AAAA): ");
+        scanf("%s", data_out);
+        long dia_in = converter_data_em_dias(data_in);
+        long dia_out = converter_data_em_dias(data_out);
+        if (dia_in == DATA_INVALIDA || dia_out == DATA_INVALIDA || dia_out <= dia_in) { // Período vazio ou mal formado
+            printf("Periodo invalido. Use o formato DD/MM/AAAA e uma data final posterior a inicial.\n");
+            return;
+        }
+        escrever_relatorio_periodo(&saida, dia_in, dia_out); // Noites [inicial, final)
+    } else if (tipo_relatorio == 2) {
+        int ano = 0;
+        printf("Digite o ano (AAAA): ");
+        scanf("%d", &ano);
+        if (ano < 0 || ano > 9999) {
+            printf("Ano invalido.\n");
+            return;
+        }
+        escrever_relatorio_mensal(&saida, ano);
+    } else {
+        printf("Opcao invalida.\n");
+        return;
+    }
+    saida_descarregar(&saida);
+}
+
+//SNAPSHOT BINARIO
+#define FNV64_INICIAL 14695981039346656037ULL // Base do FNV-1a de 64 bits (verificação do snapshot)
+
+unsigned long long fnv64_somar(unsigned long long h, const void *dados, size_t bytes) { // Continua um FNV-1a de 64 bits
+    const unsigned char *b = (const unsigned char *)dados;
+    for (size_t i = 0; i < bytes; i++) h = (h ^ b[i]) * 1099511628211ULL;
+    return h;
+}
+
+long long snapshot_escrever_secao(FILE *arquivo, const void *dados, size_t bytes, long long *posicao,
+                                  unsigned long long *verificacao) {
+    // Grava uma seção a partir da posição atual e completa com zeros até múltiplo de 8; retorna onde ela começa.
+    // 'verificacao' (NULL no cabeçalho) acumula o FNV-1a dos bytes gravados, preenchimento incluído.
+    static const char zeros[8] = {0};
+    long long inicio = *posicao;
+    if (bytes > 0) fwrite(dados, 1, bytes, arquivo);
+    size_t preenchimento = (8 - bytes % 8) % 8;
+    fwrite(zeros, 1, preenchimento, arquivo);
+    if (verificacao != NULL) {
+        if (bytes > 0) *verificacao = fnv64_somar(*verificacao, dados, bytes);
+        *verificacao = fnv64_somar(*verificacao, zeros, preenchimento);
+    }
+    *posicao += bytes + preenchimento;
+    return inicio;
+}
+
+int gravar_snapshot(const char *caminho) { // Gravação do snapshot (ver salvar_snapshot)
+    char temporario[512];
+    snprintf(temporario, sizeof(temporario), "%s.tmp", caminho);
+    FILE *arquivo = fopen(temporario, "wb");
+    if (arquivo == NULL) {
+        return ERRO_ARQUIVO;
+    }
+    setvbuf(arquivo, NULL, _IOFBF, 1 << 20); // Buffer de 1 MiB: poucas chamadas de sistema
+
+    // Achata os históricos: ids de todos os hóspedes em sequência, com o início de cada um em 'offsets'
+    int *offsets = (int *)malloc((contador_hospedes + 1) * sizeof(int));
+    HospedeArquivo *hospedes = (HospedeArquivo *)malloc((contador_hospedes + 1) * sizeof(HospedeArquivo));
+    if (offsets == NULL || hospedes == NULL) {
+        fprintf(stderr, "Erro fatal: Nao foi possivel alocar memoria para o snapshot!\n");
+        exit(1);
+    }
+    int total_ids = 0;
+    for (int i = 0; i < contador_hospedes; i++) {
+        memset(&hospedes[i], 0, sizeof(HospedeArquivo)); // Zera o preenchimento das strings
+        hospedes[i].id_hospede = hospedes_hotel[i].id_hospede;
+        strcpy(hospedes[i].nome, nome_hospede(&hospedes_hotel[i])); // O arquivo guarda o texto
+        texto_cpf(hospedes_hotel[i].cpf, hospedes[i].cpf);
+        texto_telefone(hospedes_hotel[i].telefone, hospedes[i].telefone);
+        offsets[i] = total_ids;
+        total_ids += hospedes_hotel[i].num_reservas_historico;
+    }
+    offsets[contador_hospedes] = total_ids;
+    int *ids = (int *)malloc((total_ids + 1) * sizeof(int)); // IDs de todos os históricos, em sequência
+    if (ids == NULL) {
+        fprintf(stderr, "Erro fatal: Nao foi possivel alocar memoria para o snapshot!\n");
+        exit(1);
+    }
+    for (int i = 0; i < contador_hospedes; i++) {
+        historico_copiar(&hospedes_hotel[i], ids + offsets[i]); // Blocos do pool, em ordem
+    }
+
+    CabecalhoSnapshot cabecalho;
+    memset(&cabecalho, 0, sizeof(cabecalho));
+    memcpy(cabecalho.magica, "HOTELSNP", 8);
+    cabecalho.versao = VERSAO_SNAPSHOT;
+    cabecalho.tamanho_quarto = sizeof(Quarto);
+    cabecalho.tamanho_hospede = sizeof(HospedeArquivo);
+    cabecalho.tamanho_dia = sizeof(long);
+    cabecalho.tamanho_regra = sizeof(RegraTarifa);
+    cabecalho.num_hoteis = num_hoteis;
+    cabecalho.num_hospedes = contador_hospedes;
+    cabecalho.num_ids_historico = total_ids;
+    cabecalho.ultimo_lsn = ultimo_lsn;     // Tudo até este LSN já está no snapshot
+
+    long long posicao = 0;
+    unsigned long long verificacao = FNV64_INICIAL;
+    snapshot_escrever_secao(arquivo, &cabecalho, sizeof(cabecalho), &posicao, NULL); // Reescrito no fim com os deslocamentos
+    cabecalho.inicio_hospedes = snapshot_escrever_secao(arquivo, hospedes, contador_hospedes * sizeof(HospedeArquivo), &posicao, &verificacao);
+    cabecalho.inicio_offsets_historico = snapshot_escrever_secao(arquivo, offsets, (contador_hospedes + 1) * sizeof(int), &posicao, &verificacao);
+    cabecalho.inicio_ids_historico = snapshot_escrever_secao(arquivo, ids, total_ids * sizeof(int), &posicao, &verificacao);
+    SecaoHotelSnapshot secoes[MAX_HOTEIS]; // Cada hotel: quartos, regras, reservas (uma seção contígua por coluna) e bloqueios
+    memset(secoes, 0, sizeof(secoes));
+    BloqueioManutencao *bloqueios = NULL; // Bloqueios de manutenção do hotel, tirados das agendas
+    int capacidade_bloqueios = 0;
+    for (int h = 0; h < num_hoteis; h++) {
+        const Hotel *hotel = &hoteis[h];
+        SecaoHotelSnapshot *secao = &secoes[h];
+        secao->num_quartos = hotel->contador_quartos;
+        secao->num_reservas = hotel->contador_reservas;
+        secao->num_arquivadas = hotel->contador_arquivadas;
+        secao->num_regras = hotel->contador_regras;
+        secao->inicio_quartos = snapshot_escrever_secao(arquivo, hotel->quartos_hotel,
+                                                        hotel->contador_quartos * sizeof(Quarto), &posicao, &verificacao);
+        secao->inicio_regras = snapshot_escrever_secao(arquivo, hotel->regras_tarifa,
+                                                       hotel->contador_regras * sizeof(RegraTarifa), &posicao, &verificacao);
+        ColunaReserva colunas[NUM_COLUNAS_RESERVA];
+        colunas_reservas(&hotel->reservas_hotel, colunas);
+        for (int k = 0; k < NUM_COLUNAS_RESERVA; k++) {
+            secao->inicio_colunas_reservas[k] = snapshot_escrever_secao(arquivo, colunas[k].dados,
+                                                                        hotel->contador_reservas * colunas[k].tamanho_elemento, &posicao, &verificacao);
+        }
+        colunas_reservas(&hotel->reservas_arquivadas, colunas);
+        for (int k = 0; k < NUM_COLUNAS_RESERVA; k++) {
+            secao->inicio_colunas_arquivadas[k] = snapshot_escrever_secao(arquivo, colunas[k].dados,
+                                                                          hotel->contador_arquivadas * colunas[k].tamanho_elemento, &posicao, &verificacao);
+        }
+        for (int q = 0; q < hotel->contador_quartos; q++) { // Reservas refazem a agenda na carga; os bloqueios vão à parte
+            const AgendaQuarto *agenda = &hotel->agendas_quartos[q];
+            for (int k = 0; k < agenda->num_intervalos; k++) {
+                if (agenda->intervalos[k].id_reserva != BLOQUEIO_MANUTENCAO) continue;
+                bloqueios = (BloqueioManutencao *)crescer_vetor(bloqueios, &capacidade_bloqueios, secao->num_bloqueios + 1,
+                                                                sizeof(BloqueioManutencao), "o snapshot");
+                BloqueioManutencao *b = &bloqueios[secao->num_bloqueios++];
+                memset(b, 0, sizeof(*b));
+                b->numero_quarto = hotel->quartos_hotel[q].numero;
+                b->inicio = agenda->intervalos[k].checkin;
+                b->fim = agenda->intervalos[k].checkout;
+            }
+        }
+        secao->inicio_bloqueios = snapshot_escrever_secao(arquivo, bloqueios, secao->num_bloqueios * sizeof(BloqueioManutencao), &posicao, &verificacao);
+    }
+    free(bloqueios);
+    cabecalho.inicio_hoteis = snapshot_escrever_secao(arquivo, secoes, num_hoteis * sizeof(SecaoHotelSnapshot), &posicao, &verificacao);
+    cabecalho.tamanho_total = posicao;
+    cabecalho.verificacao = fnv64_somar(verificacao, &cabecalho, sizeof(cabecalho)); // Campo ainda zerado na conta
+
+    fseek(arquivo, 0, SEEK_SET);           // Cabeçalho definitivo, agora com os deslocamentos
+    fwrite(&cabecalho, sizeof(cabecalho), 1, arquivo);
+    int falhou = ferror(arquivo);
+    falhou |= (fflush(arquivo) != 0);
+#ifdef PLATAFORMA_POSIX
+    falhou |= (fsync(fileno(arquivo)) != 0); // O snapshot precisa estar em disco antes de o journal ser esvaziado
+#endif
+    falhou |= (fclose(arquivo) != 0);
+    free(offsets);
+    free(hospedes);
+    free(ids);
+    if (falhou || rename(temporario, caminho) != 0) { // Só substitui o snapshot anterior se tudo foi gravado
+        remove(temporario);
+        return ERRO_ARQUIVO;
+    }
+    if (arquivo_journal != NULL && strcmp(caminho, ARQUIVO_SNAPSHOT) == 0) { // Snapshot padrão cobre todo o journal
+        travar(&trava_journal);            // Clientes do servidor confirmam o journal fora de trava_estrutura
+        usado_journal = 0;                 // Registros pendentes já estão no snapshot
+        pendentes_journal = 0;
+        fflush(arquivo_journal);
+#ifdef PLATAFORMA_POSIX
+        if (ftruncate(fileno(arquivo_journal), 0) == 0 && fsync(fileno(arquivo_journal)) != 0) {
+            fprintf(stderr, "Erro fatal: Nao foi possivel gravar o journal!\n");
+            exit(1);                       // Journal em estado incerto: novos registros não teriam garantia
+        }
+#else
+        arquivo_journal = freopen(ARQUIVO_JOURNAL, "wb", arquivo_journal);
+#endif
+        destravar(&trava_journal);
+    }
+    return OPERACAO_OK;
+}
+
+int salvar_snapshot(const char *caminho) { // Grava as tabelas da rede em 'caminho' (via arquivo temporário + rename)
+    MEDIR_INICIO(MEDIDA_SALVAR_SNAPSHOT);
+    int codigo = gravar_snapshot(caminho);
+    MEDIR_FIM(MEDIDA_SALVAR_SNAPSHOT, total_quartos_rede() + contador_hospedes + total_reservas_rede() + total_regras_rede()); // Registros
+    return codigo;
+}
+
+int snapshot_validar_hotel(const SecaoHotelSnapshot *s, long long tamanho) { // Limites das seções de um hotel
+    if (s->num_quartos < 0 || s->num_reservas < 0 || s->num_arquivadas < 0 || s->num_regras < 0 || s->num_bloqueios < 0) return 0;
+    if (s->inicio_quartos < 0 || s->inicio_regras < 0 || s->inicio_bloqueios < 0) return 0;
+    if ((s->inicio_quartos | s->inicio_regras | s->inicio_bloqueios) % 8 != 0) return 0; // Seções alinhadas em 8 bytes
+    if (s->inicio_bloqueios + (long long)s->num_bloqueios * (long long)sizeof(BloqueioManutencao) > tamanho) return 0;
+    if (s->inicio_quartos + (long long)s->num_quartos * (long long)sizeof(Quarto) > tamanho) return 0;
+    if (s->inicio_regras + (long long)s->num_regras * (long long)sizeof(RegraTarifa) > tamanho) return 0;
+    ColunaReserva colunas[NUM_COLUNAS_RESERVA]; // Só os tamanhos dos elementos interessam aqui
+    colunas_reservas(&hotel_atual->reservas_hotel, colunas);
+    for (int k = 0; k < NUM_COLUNAS_RESERVA; k++) {
+        if ((s->inicio_colunas_reservas[k] | s->inicio_colunas_arquivadas[k]) % 8 != 0) return 0;
+        if (s->inicio_colunas_reservas[k] < 0 ||
+            s->inicio_colunas_reservas[k] + (long long)s->num_reservas * (long long)colunas[k].tamanho_elemento > tamanho) return 0;
+        if (s->inicio_colunas_arquivadas[k] < 0 ||
+            s->inicio_colunas_arquivadas[k] + (long long)s->num_arquivadas * (long long)colunas[k].tamanho_elemento > tamanho) return 0;
+    }
+    return 1;
+}
+
+int comparar_cpfs(const void *a, const void *b) { // Ordem crescente de CPF codificado (qsort)
+    unsigned long long x = *(const unsigned long long *)a, y = *(const unsigned long long *)b;
+    return (x > y) - (x < y);
+}
+
+int snapshot_conferir_hotel(const unsigned char *dados, const SecaoHotelSnapshot *s, int num_hospedes, int *dono) {
+    // Conteúdo de um hotel, antes de tocar nas tabelas. 'dono' (num_reservas + num_arquivadas + 1 posições zeradas)
+    // recebe o hóspede de cada ID de reserva, para conferir os históricos depois.
+    long primeiro_dia = contar_dias(1, 1, 0), ultimo_dia = contar_dias(31, 12, 9999); // Datas que o cadastro aceita
+    const Quarto *quartos = (const Quarto *)(dados + s->inicio_quartos);
+    int *numeros = (int *)malloc((s->num_quartos + 1) * sizeof(int)); // Números em ordem, para busca binária
+    if (numeros == NULL) {
+        fprintf(stderr, "Erro fatal: Nao foi possivel alocar memoria para o snapshot!\n");
+        exit(1);
+    }
+    int valido = 1;
+    for (int q = 0; q < s->num_quartos && valido; q++) {
+        numeros[q] = quartos[q].numero;
+        valido = quartos[q].status >= LIVRE && quartos[q].status <= MANUTENCAO && quartos[q].preco_diaria >= 0 &&
+                 memchr(quartos[q].tipo, '\0', TAM_TIPO) != NULL; // NaN também falha na comparação
+    }
+    qsort(numeros, s->num_quartos, sizeof(int), comparar_inteiros);
+    for (int q = 1; q < s->num_quartos && valido; q++) {
+        valido = (numeros[q] != numeros[q - 1]); // Número de quarto único
+    }
+    const RegraTarifa *regras = (const RegraTarifa *)(dados + s->inicio_regras);
+    for (int i = 0; i < s->num_regras && valido; i++) { // Mesmas faixas do cadastro
+        valido = memchr(regras[i].tipo, '\0', TAM_TIPO) != NULL && regras[i].fim > regras[i].inicio &&
+                 regras[i].dias_semana > 0 && regras[i].dias_semana <= TODOS_OS_DIAS &&
+                 regras[i].percentual >= 0 && regras[i].percentual <= MAX_PERCENTUAL_TARIFA;
+    }
+    int total = s->num_reservas + s->num_arquivadas;
+    for (int t = 0; t < 2 && valido; t++) { // IDs 1..total sem lacunas, hóspede e quarto existentes, datas na faixa
+        ColunaReserva colunas[NUM_COLUNAS_RESERVA];
+        TabelaReservas tabela;
+        const long long *inicios = (t == 0) ? s->inicio_colunas_reservas : s->inicio_colunas_arquivadas;
+        int quantidade = (t == 0) ? s->num_reservas : s->num_arquivadas;
+        colunas_reservas(&hotel_atual->reservas_hotel, colunas); // Só os tamanhos; os dados vêm do arquivo
+        for (int k = 0; k < NUM_COLUNAS_RESERVA; k++) colunas[k].dados = (void *)(dados + inicios[k]);
+        definir_colunas_reservas(&tabela, colunas);
+        for (int i = 0; i < quantidade && valido; i++) {
+            int id = tabela.id_reserva[i];
+            int status = tabela.status_reserva[i];
+            valido = id >= 1 && id <= total && dono[id] == 0 &&
+                     ((t == 0) ? status == ATIVA : (status == CONCLUIDA || status == CANCELADA)) &&
+                     tabela.id_hospede[i] >= 1 && tabela.id_hospede[i] <= num_hospedes &&
+                     bsearch(&tabela.numero_quarto[i], numeros, s->num_quartos, sizeof(int), comparar_inteiros) != NULL &&
+                     tabela.dia_checkin[i] >= primeiro_dia && tabela.dia_checkin[i] < tabela.dia_checkout[i] &&
+                     tabela.dia_checkout[i] <= ultimo_dia && tabela.valor_centavos[i] >= 0;
+            if (valido) dono[id] = tabela.id_hospede[i];
+        }
+    }
+    const BloqueioManutencao *bloqueios = (const BloqueioManutencao *)(dados + s->inicio_bloqueios);
+    for (int i = 0; i < s->num_bloqueios && valido; i++) {
+        valido = bsearch(&bloqueios[i].numero_quarto, numeros, s->num_quartos, sizeof(int), comparar_inteiros) != NULL &&
+                 bloqueios[i].inicio >= primeiro_dia && bloqueios[i].inicio < bloqueios[i].fim && bloqueios[i].fim <= ultimo_dia;
+    }
+    free(numeros);
+    return valido;
+}
+
+int snapshot_conferir(const unsigned char *dados) { // Referências entre seções: só passa o que o cadastro teria produzido
+    const CabecalhoSnapshot *c = (const CabecalhoSnapshot *)dados;
+    const HospedeArquivo *hospedes = (const HospedeArquivo *)(dados + c->inicio_hospedes);
+    const int *offsets = (const int *)(dados + c->inicio_offsets_historico);
+    const int *ids = (const int *)(dados + c->inicio_ids_historico);
+    const SecaoHotelSnapshot *secoes = (const SecaoHotelSnapshot *)(dados + c->inicio_hoteis);
+    unsigned long long *cpfs = (unsigned long long *)malloc((c->num_hospedes + 1) * sizeof(unsigned long long));
+    int *donos[MAX_HOTEIS] = {NULL};       // Hóspede de cada ID de reserva, por hotel
+    int totais[MAX_HOTEIS];
+    if (cpfs == NULL) {
+        fprintf(stderr, "Erro fatal: Nao foi possivel alocar memoria para o snapshot!\n");
+        exit(1);
+    }
+    int valido = 1;
+    for (int i = 0; i < c->num_hospedes && valido; i++) { // IDs 1..n na ordem, CPF e telefone aceitos pelo cadastro
+        HospedeArquivo registro = hospedes[i];
+        unsigned long long telefone;
+        registro.cpf[TAM_CPF - 1] = registro.telefone[TAM_TELEFONE - 1] = '\0';
+        valido = hospedes[i].id_hospede == i + 1 && codificar_cpf(registro.cpf, &cpfs[i]) &&
+                 codificar_telefone(registro.telefone, &telefone);
+    }
+    qsort(cpfs, valido ? c->num_hospedes : 0, sizeof(unsigned long long), comparar_cpfs);
+    for (int i = 1; i < c->num_hospedes && valido; i++) {
+        valido = (cpfs[i] != cpfs[i - 1]); // CPF único
+    }
+    free(cpfs);
+    for (int h = 0; h < c->num_hoteis && valido; h++) {
+        totais[h] = secoes[h].num_reservas + secoes[h].num_arquivadas;
+        donos[h] = (int *)calloc(totais[h] + 1, sizeof(int));
+        if (donos[h] == NULL) {
+            fprintf(stderr, "Erro fatal: Nao foi possivel alocar memoria para o snapshot!\n");
+            exit(1);
+        }
+        valido = snapshot_conferir_hotel(dados, &secoes[h], c->num_hospedes, donos[h]);
+    }
+    for (int i = 0; i < c->num_hospedes && valido; i++) { // Histórico: reservas reais do próprio hóspede
+        for (int k = offsets[i]; k < offsets[i + 1] && valido; k++) {
+            int hotel = ids[k] % MAX_HOTEIS, id = ids[k] / MAX_HOTEIS;
+            valido = ids[k] >= 0 && hotel < c->num_hoteis && id >= 1 && id <= totais[hotel] && donos[hotel][id] == i + 1;
+        }
+    }
+    for (int h = 0; h < c->num_hoteis; h++) {
+        free(donos[h]);
+    }
+    return valido;
+}
+
+int snapshot_validar(const unsigned char *dados, long long tamanho) { // Confere cabeçalho, verificação, limites e conteúdo
+    const CabecalhoSnapshot *c = (const CabecalhoSnapshot *)dados;
+    if (tamanho < (long long)sizeof(CabecalhoSnapshot)) return 0;
+    if (memcmp(c->magica, "HOTELSNP", 8) != 0 || c->versao != VERSAO_SNAPSHOT) return 0;
+    if (c->tamanho_quarto != sizeof(Quarto) || c->tamanho_hospede != sizeof(HospedeArquivo) ||
+        c->tamanho_dia != sizeof(long) || c->tamanho_regra != sizeof(RegraTarifa)) return 0;
+    if (c->num_hoteis < 1 || c->num_hoteis > MAX_HOTEIS || c->num_hospedes < 0 || c->num_ids_historico < 0) return 0;
+    if (c->tamanho_total != tamanho) return 0;
+    CabecalhoSnapshot copia = *c;          // Verificação: seções depois do cabeçalho, e o cabeçalho com o campo zerado
+    copia.verificacao = 0;
+    unsigned long long verificacao = fnv64_somar(FNV64_INICIAL, dados + sizeof(CabecalhoSnapshot), tamanho - sizeof(CabecalhoSnapshot));
+    if (fnv64_somar(verificacao, &copia, sizeof(copia)) != c->verificacao) return 0;
+    if (c->inicio_hospedes < 0 || c->inicio_offsets_historico < 0 || c->inicio_ids_historico < 0 || c->inicio_hoteis < 0) return 0;
+    if ((c->inicio_hospedes | c->inicio_offsets_historico | c->inicio_ids_historico | c->inicio_hoteis) % 8 != 0) return 0;
+    if (c->inicio_hospedes + (long long)c->num_hospedes * (long long)sizeof(HospedeArquivo) > tamanho) return 0;
+    if (c->inicio_offsets_historico + (long long)(c->num_hospedes + 1) * (long long)sizeof(int) > tamanho) return 0;
+    if (c->inicio_ids_historico + (long long)c->num_ids_historico * (long long)sizeof(int) > tamanho) return 0;
+    if (c->inicio_hoteis + (long long)c->num_hoteis * (long long)sizeof(SecaoHotelSnapshot) > tamanho) return 0;
+    const SecaoHotelSnapshot *secoes = (const SecaoHotelSnapshot *)(dados + c->inicio_hoteis);
+    for (int h = 0; h < c->num_hoteis; h++) {
+        if (!snapshot_validar_hotel(&secoes[h], tamanho)) return 0;
+    }
+    const int *offsets = (const int *)(dados + c->inicio_offsets_historico);
+    for (int i = 0; i < c->num_hospedes; i++) { // Offsets precisam ser crescentes e dentro da seção de ids
+        if (offsets[i] < 0 || offsets[i] > offsets[i + 1]) return 0;
+    }
+    return offsets[c->num_hospedes] == c->num_ids_historico && snapshot_conferir(dados);
+}
+
+int snapshot_importar_hotel(const unsigned char *dados, const SecaoHotelSnapshot *s) { // Seções de um hotel em hotel_atual
+    Hotel *hotel = hotel_atual;
+
+    // Quartos e reservas: cópia direta dos blocos, sem interpretar registro a registro
+    if (s->num_quartos > 0) {
+        reservar_quartos(s->num_quartos);
+        memcpy(hotel->quartos_hotel, dados + s->inicio_quartos, (size_t)s->num_quartos * sizeof(Quarto));
+    }
+    if (s->num_regras > 0) {
+        hotel->regras_tarifa = (RegraTarifa *)crescer_vetor(hotel->regras_tarifa, &hotel->capacidade_regras, s->num_regras,
+                                                            sizeof(RegraTarifa), "regra de tarifa");
+        memcpy(hotel->regras_tarifa, dados + s->inicio_regras, (size_t)s->num_regras * sizeof(RegraTarifa));
+    }
+    ColunaReserva colunas[NUM_COLUNAS_RESERVA];
+    if (s->num_reservas > 0) {
+        reservar_reservas(s->num_reservas);
+        colunas_reservas(&hotel->reservas_hotel, colunas);
+        for (int k = 0; k < NUM_COLUNAS_RESERVA; k++) { // Cada coluna é um bloco só
+            memcpy(colunas[k].dados, dados + s->inicio_colunas_reservas[k], (size_t)s->num_reservas * colunas[k].tamanho_elemento);
+        }
+    }
+    if (s->num_arquivadas > 0) {
+        reservar_arquivadas(s->num_arquivadas);
+        colunas_reservas(&hotel->reservas_arquivadas, colunas);
+        for (int k = 0; k < NUM_COLUNAS_RESERVA; k++) {
+            memcpy(colunas[k].dados, dados + s->inicio_colunas_arquivadas[k], (size_t)s->num_arquivadas * colunas[k].tamanho_elemento);
+        }
+    }
+
+    for (hotel->contador_regras = 0; hotel->contador_regras < s->num_regras; hotel->contador_regras++) { // Mesmas faixas do cadastro
+        RegraTarifa *regra = &hotel->regras_tarifa[hotel->contador_regras];
+        regra->tipo[TAM_TIPO - 1] = '\0';
+        if (regra->fim <= regra->inicio || regra->dias_semana <= 0 || regra->dias_semana > TODOS_OS_DIAS ||
+            regra->percentual < 0 || regra->percentual > MAX_PERCENTUAL_TARIFA) return ERRO_SNAPSHOT_INVALIDO;
+    }
+
+    // Índices derivados: números de quarto e agendas
+    for (hotel->contador_quartos = 0; hotel->contador_quartos < s->num_quartos; hotel->contador_quartos++) {
+        const Quarto *q = &hotel->quartos_hotel[hotel->contador_quartos];
+        if (verificar_quarto_existe(q->numero) || q->status < LIVRE || q->status > MANUTENCAO) return ERRO_SNAPSHOT_INVALIDO;
+        indice_quartos_adicionar(hotel->contador_quartos);
+        hotel->quartos_hotel[hotel->contador_quartos].tipo[TAM_TIPO - 1] = '\0'; // Garante terminação antes de classificar o tipo
+        analise_adicionar_quarto(hotel->contador_quartos);
+        indice_preco_adicionar(hotel->contador_quartos);
+    }
+    for (hotel->contador_reservas = 0; hotel->contador_reservas < s->num_reservas; hotel->contador_reservas++) { // Só ATIVA
+        if (hotel->reservas_hotel.status_reserva[hotel->contador_reservas] != ATIVA ||
+            !indice_reservas_id_adicionar(&hotel->reservas_hotel, hotel->contador_reservas, 0)) return ERRO_SNAPSHOT_INVALIDO;
+    }
+    for (hotel->contador_arquivadas = 0; hotel->contador_arquivadas < s->num_arquivadas; hotel->contador_arquivadas++) { // Nunca ATIVA
+        if (hotel->reservas_arquivadas.status_reserva[hotel->contador_arquivadas] == ATIVA ||
+            !indice_reservas_id_adicionar(&hotel->reservas_arquivadas, hotel->contador_arquivadas, 1)) return ERRO_SNAPSHOT_INVALIDO;
+    }
+    for (int t = 0; t < 2; t++) {          // Agendas e agregados: anexa sem ordenar; ordena cada agenda no fim
+        const TabelaReservas *tabela = (t == 0) ? &hotel->reservas_hotel : &hotel->reservas_arquivadas;
+        int quantidade = (t == 0) ? hotel->contador_reservas : hotel->contador_arquivadas;
+        for (int i = 0; i < quantidade; i++) { // Concluídas continuam na agenda; canceladas não
+            if (tabela->dia_checkout[i] <= tabela->dia_checkin[i]) return ERRO_SNAPSHOT_INVALIDO;
+            if (tabela->status_reserva[i] == CANCELADA) continue;
+            int indice_quarto = buscar_quarto_por_numero(tabela->numero_quarto[i]);
+            if (indice_quarto == -1) continue;
+            AgendaQuarto *agenda = &hotel->agendas_quartos[indice_quarto];
+            IntervaloReserva intervalo = {tabela->dia_checkin[i], tabela->dia_checkout[i], 0, tabela->id_reserva[i]};
+            agenda->intervalos = (IntervaloReserva *)anexar_registros(agenda->intervalos, &agenda->num_intervalos,
+                                                                      &agenda->capacidade, &intervalo, 1,
+                                                                      sizeof(IntervaloReserva), "agenda do quarto");
+            analise_registrar(indice_quarto, tabela->dia_checkin[i], tabela->dia_checkout[i], tabela->valor_centavos[i], 1);
+        }
+    }
+    const BloqueioManutencao *bloqueios = (const BloqueioManutencao *)(dados + s->inicio_bloqueios);
+    for (int i = 0; i < s->num_bloqueios; i++) { // Bloqueios entram na agenda, fora dos agregados de receita
+        int indice_quarto = buscar_quarto_por_numero(bloqueios[i].numero_quarto);
+        if (indice_quarto == -1 || bloqueios[i].fim <= bloqueios[i].inicio) return ERRO_SNAPSHOT_INVALIDO;
+        AgendaQuarto *agenda = &hotel->agendas_quartos[indice_quarto];
+        IntervaloReserva intervalo = {bloqueios[i].inicio, bloqueios[i].fim, 0, BLOQUEIO_MANUTENCAO};
+        agenda->intervalos = (IntervaloReserva *)anexar_registros(agenda->intervalos, &agenda->num_intervalos,
+                                                                  &agenda->capacidade, &intervalo, 1,
+                                                                  sizeof(IntervaloReserva), "agenda do quarto");
+    }
+    for (int i = 0; i < hotel->contador_quartos; i++) {
+        agenda_ordenar(i);
+    }
+    hotel->calendario_valido = 0;          // Bitmaps são refeitos das agendas na primeira consulta
+    hotel->versao_reservas++;              // Vista anterior (tabelas vazias) não vale mais
+    return OPERACAO_OK;
+}
+
+int snapshot_importar(const unsigned char *dados) { // Copia as seções já validadas para as tabelas e refaz os índices
+    const CabecalhoSnapshot *c = (const CabecalhoSnapshot *)dados;
+    const HospedeArquivo *hospedes = (const HospedeArquivo *)(dados + c->inicio_hospedes);
+    const int *offsets = (const int *)(dados + c->inicio_offsets_historico);
+    const int *ids = (const int *)(dados + c->inicio_ids_historico);
+    const SecaoHotelSnapshot *secoes = (const SecaoHotelSnapshot *)(dados + c->inicio_hoteis);
+
+    reservar_hospedes(c->num_hospedes);
+    for (int i = 0; i < c->num_hospedes; i++) { // Hóspedes: campos fixos + histórico vindo da seção achatada
+        Hospede *h = &hospedes_hotel[i];
+        HospedeArquivo registro = hospedes[i]; // Cópia local: o arquivo é só leitura
+        registro.nome[TAM_NOME - 1] = registro.cpf[TAM_CPF - 1] = registro.telefone[TAM_TELEFONE - 1] = '\0'; // Garante terminação
+        if (!codificar_cpf(registro.cpf, &h->cpf) || !codificar_telefone(registro.telefone, &h->telefone)) {
+            return ERRO_SNAPSHOT_INVALIDO; // Texto que o cadastro não aceitaria
+        }
+        h->id_hospede = registro.id_hospede;
+        h->nome = arena_nomes_adicionar(registro.nome);
+        h->primeiro_bloco_historico = h->ultimo_bloco_historico = -1;
+        h->num_reservas_historico = 0;
+        for (int k = offsets[i]; k < offsets[i + 1]; k++) { // Histórico: blocos novos no fim do pool
+            historico_anexar(h, ids[k]);
+        }
+    }
+    for (contador_hospedes = 0; contador_hospedes < c->num_hospedes; contador_hospedes++) { // Índices de CPF, ID e nome
+        if (buscar_hospede_por_codigo_cpf(hospedes_hotel[contador_hospedes].cpf) != -1) return ERRO_SNAPSHOT_INVALIDO; // CPF repetido
+        indice_cpf_adicionar(contador_hospedes);
+        if (!indice_hospedes_id_adicionar(contador_hospedes)) return ERRO_SNAPSHOT_INVALIDO; // ID repetido
+        indice_nomes_adicionar(contador_hospedes);
+    }
+
+    Hotel *anterior = hotel_atual;
+    int codigo = OPERACAO_OK;
+    num_hoteis = c->num_hoteis;
+    for (int h = 0; h < num_hoteis && codigo == OPERACAO_OK; h++) { // Cada hotel com o núcleo operando sobre ele
+        hotel_atual = &hoteis[h];
+        codigo = snapshot_importar_hotel(dados, &secoes[h]);
+    }
+    hotel_atual = anterior;
+    if (codigo == OPERACAO_OK) ultimo_lsn = c->ultimo_lsn; // A recuperação do journal continua a partir daqui
+    return codigo;
+}
+
+int ler_snapshot(const char *caminho) {   // Carga do snapshot (ver carregar_snapshot)
+    int resultado;
+#ifdef PLATAFORMA_POSIX
+    int descritor = open(caminho, O_RDONLY);
+    if (descritor < 0) {
+        return ERRO_ARQUIVO;
+    }
+    struct stat info;
+    if (fstat(descritor, &info) != 0 || info.st_size == 0) {
+        close(descritor);
+        return (info.st_size == 0) ? ERRO_SNAPSHOT_INVALIDO : ERRO_ARQUIVO;
+    }
+    void *mapa = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, descritor, 0); // Arquivo mapeado: sem cópia para buffer
+    close(descritor);
+    if (mapa == MAP_FAILED) {
+        return ERRO_ARQUIVO;
+    }
+    madvise(mapa, info.st_size, MADV_SEQUENTIAL); // Leitura será sequencial, seção a seção
+    if (snapshot_validar((const unsigned char *)mapa, info.st_size)) {
+        resultado = snapshot_importar((const unsigned char *)mapa);
+    } else {
+        resultado = ERRO_SNAPSHOT_INVALIDO;
+    }
+    munmap(mapa, info.st_size);
+#else
+    FILE *arquivo = fopen(caminho, "rb"); // Sem mmap: lê o arquivo inteiro para a memória
+    if (arquivo == NULL) {
+        return ERRO_ARQUIVO;
+    }
+    fseek(arquivo, 0, SEEK_END);
+    long tamanho = ftell(arquivo);
+    fseek(arquivo, 0, SEEK_SET);
+    unsigned char *dados = (unsigned char *)malloc(tamanho > 0 ? tamanho : 1);
+    if (dados == NULL || fread(dados, 1, tamanho, arquivo) != (size_t)tamanho) {
+        free(dados);
+        fclose(arquivo);
+        return ERRO_ARQUIVO;
+    }
+    fclose(arquivo);
+    resultado = snapshot_validar(dados, tamanho) ? snapshot_importar(dados) : ERRO_SNAPSHOT_INVALIDO;
+    free(dados);
+#endif
+    return resultado;
+}
+
+int carregar_snapshot(const char *caminho) { // Carrega um snapshot nas tabelas (que devem estar vazias em toda a rede)
+    if (total_quartos_rede() != 0 || contador_hospedes != 0 || total_reservas_rede() != 0) {
+        return ERRO_SNAPSHOT_INVALIDO;     // Não mistura snapshot com dados já cadastrados
+    }
+    MEDIR_INICIO(MEDIDA_CARREGAR_SNAPSHOT);
+    int codigo = ler_snapshot(caminho);
+    if (codigo == ERRO_SNAPSHOT_INVALIDO) {
+        liberar_tabelas();                 // Nada da carga parcial fica: a rede volta a estar vazia
+    }
+    MEDIR_FIM(MEDIDA_CARREGAR_SNAPSHOT, total_quartos_rede() + contador_hospedes + total_reservas_rede() + total_regras_rede()); // Registros
+    return codigo;
+}
+
+void salvar_snapshot_menu() {              // Opção de menu: grava o snapshot padrão
+    if (salvar_snapshot(ARQUIVO_SNAPSHOT) == OPERACAO_OK) {
+        printf("Snapshot gravado em %s (%d quartos, %d hospedes, %d reservas).\n",
+               ARQUIVO_SNAPSHOT, total_quartos_rede(), contador_hospedes, total_reservas_rede());
+    } else {
+        printf("ERRO: Nao foi possivel gravar o snapshot em %s.\n", ARQUIVO_SNAPSHOT);
+    }
+}
+
+//RECUPERACAO DO JOURNAL
+int journal_aplicar(const CabecalhoJournal *cabecalho, const void *conteudo) { // Refaz uma alteração; OPERACAO_OK se reproduziu
+    switch (cabecalho->tipo) {
+        case JOURNAL_QUARTO: {
+            const Quarto *q = (const Quarto *)conteudo;
+            if (cabecalho->tamanho != sizeof(Quarto)) break;
+            return inserir_quarto(q->numero, q->tipo, q->preco_diaria, q->status);
+        }
+        case JOURNAL_HOSPEDE: {
+            const HospedeArquivo *h = (const HospedeArquivo *)conteudo;
+            int id;
+            if (cabecalho->tamanho != sizeof(HospedeArquivo)) break;
+            int codigo = inserir_hospede(h->cpf, h->nome, h->telefone, &id);
+            return (codigo == OPERACAO_OK && id != h->id_hospede) ? ERRO_SNAPSHOT_INVALIDO : codigo;
+        }
+        case JOURNAL_RESERVA: {
+            const RegistroJournalReserva *r = (const RegistroJournalReserva *)conteudo;
+            int id;
+            if (cabecalho->tamanho != sizeof(RegistroJournalReserva)) break;
+            int codigo = criar_reserva(buscar_hospede_por_cpf(r->cpf), r->numero_quarto, r->dia_checkin, r->dia_checkout, &id, NULL);
+            return (codigo == OPERACAO_OK && id != r->id_reserva) ? ERRO_SNAPSHOT_INVALIDO : codigo;
+        }
+        case JOURNAL_STATUS_RESERVA: {
+            const RegistroJournalStatus *r = (const RegistroJournalStatus *)conteudo;
+            if (cabecalho->tamanho != sizeof(RegistroJournalStatus)) break;
+            return alterar_status_reserva(r->id_reserva, r->novo_status);
+        }
+        case JOURNAL_MANUTENCAO:
+        case JOURNAL_FIM_MANUTENCAO: {
+            const BloqueioManutencao *b = (const BloqueioManutencao *)conteudo;
+            if (cabecalho->tamanho != sizeof(BloqueioManutencao)) break;
+            return (cabecalho->tipo == JOURNAL_MANUTENCAO) ? bloquear_manutencao(b->numero_quarto, b->inicio, b->fim)
+                                                           : liberar_manutencao(b->numero_quarto, b->inicio, b->fim);
+        }
+        case JOURNAL_TARIFA: {
+            RegraTarifa r;
+            if (cabecalho->tamanho != sizeof(RegraTarifa)) break;
+            memcpy(&r, conteudo, sizeof(r));
+            r.tipo[TAM_TIPO - 1] = '\0';
+            return inserir_regra_tarifa(r.tipo, r.inicio, r.fim, r.dias_semana, r.percentual);
+        }
+    }
+    return ERRO_SNAPSHOT_INVALIDO;         // Tipo ou tamanho desconhecido
+}
+
+int journal_recuperar(const char *caminho) { // Reaplica o journal sobre o snapshot carregado; retorna registros aplicados
+    FILE *arquivo = fopen(caminho, "rb");
+    if (arquivo == NULL) {                 // Sem journal: nada a recuperar
+        return 0;
+    }
+    setvbuf(arquivo, NULL, _IOFBF, 1 << 20);
+    char *conteudo = (char *)malloc(TAM_BUFFER_JOURNAL);
+    if (conteudo == NULL) {
+        fprintf(stderr, "Erro fatal: Nao foi possivel alocar memoria para o journal!\n");
+        exit(1);
+    }
+    CabecalhoJournal cabecalho;
+    long valido = 0;                       // Fim do último registro íntegro
+    int aplicados = 0;
+    while (fread(&cabecalho, sizeof(cabecalho), 1, arquivo) == 1) {
+        if (cabecalho.tamanho > TAM_BUFFER_JOURNAL - sizeof(cabecalho) ||
+            fread(conteudo, 1, cabecalho.tamanho, arquivo) != cabecalho.tamanho ||
+            verificacao_journal(&cabecalho, conteudo) != cabecalho.verificacao) {
+            break;                         // Registro incompleto ou corrompido: gravação interrompida por queda
+        }
+        if (cabecalho.lsn > ultimo_lsn) {  // Registros até o LSN do snapshot já estão aplicados
+            if (cabecalho.hotel < 0 || cabecalho.hotel >= MAX_HOTEIS ||
+                selecionar_hotel(cabecalho.hotel + 1) != OPERACAO_OK || // Cria o hotel se o snapshot não o tinha
+                journal_aplicar(&cabecalho, conteudo) != OPERACAO_OK) {
+                fprintf(stderr, "AVISO: Registro %lld do journal nao pode ser reaplicado.\n", cabecalho.lsn);
+            }
+            ultimo_lsn = cabecalho.lsn;
+            aplicados++;
+        }
+        valido = ftell(arquivo);
+    }
+    hotel_atual = &hoteis[0];              // Execução começa no primeiro hotel
+    fseek(arquivo, 0, SEEK_END);
+    long tamanho = ftell(arquivo);
+    fclose(arquivo);
+    free(conteudo);
+    if (tamanho > valido) {                // Descarta a cauda inválida para os novos registros começarem íntegros
+        fprintf(stderr, "AVISO: %ld bytes finais do journal descartados (gravacao incompleta).\n", tamanho - valido);
+#ifdef PLATAFORMA_POSIX
+        if (truncate(caminho, valido) != 0) fprintf(stderr, "AVISO: Nao foi possivel truncar o journal.\n");
+#endif
+    }
+    return aplicados;
+}
+
+void iniciar_persistencia() {              // Carrega o snapshot, reaplica o journal e passa a registrar alterações
+    int carga = carregar_snapshot(ARQUIVO_SNAPSHOT); // Retoma o estado salvo na execução anterior, se houver
+    if (carga == OPERACAO_OK) {
+        fprintf(stderr, "Snapshot %s carregado: %d quartos, %d hospedes, %d reservas.\n",
+                ARQUIVO_SNAPSHOT, total_quartos_rede(), contador_hospedes, total_reservas_rede());
+    } else if (carga == ERRO_SNAPSHOT_INVALIDO) { // Arquivo ausente (ERRO_ARQUIVO) é o caso normal da primeira execução
+        // O journal só vale sobre esse snapshot: os dois são postos de lado, e o próximo SALVAR não os sobrescreve
+        rename(ARQUIVO_SNAPSHOT, ARQUIVO_SNAPSHOT ".invalido");
+        rename(ARQUIVO_JOURNAL, ARQUIVO_JOURNAL ".invalido");
+        fprintf(stderr, "AVISO: %s invalido ou incompativel; preservado em %s.invalido (com o journal); iniciando sem dados.\n",
+                ARQUIVO_SNAPSHOT, ARQUIVO_SNAPSHOT);
+    }
+    int aplicados = journal_recuperar(ARQUIVO_JOURNAL);
+    if (aplicados > 0) {
+        fprintf(stderr, "Journal %s: %d alteracoes recuperadas.\n", ARQUIVO_JOURNAL, aplicados);
+    }
+    arquivo_journal = fopen(ARQUIVO_JOURNAL, "ab"); // A partir daqui toda alteração é registrada
+    if (arquivo_journal == NULL) {
+        fprintf(stderr, "AVISO: Nao foi possivel abrir %s; alteracoes nao serao registradas.\n", ARQUIVO_JOURNAL);
+    }
+}
+
+void encerrar_persistencia() {             // Confirma o que estiver pendente e fecha o journal
+    journal_confirmar();
+    if (arquivo_journal != NULL) {
+        fclose(arquivo_journal);
+        arquivo_journal = NULL;
+    }
+}
+
+//IMPORTACAO E EXPORTACAO CSV/JSON
+// Importação: o CSV é lido em janelas de linhas inteiras; cada janela é dividida em blocos convertidos em
+// paralelo (campos -> registros) e os registros entram em sequência, na ordem do arquivo, pelas mesmas
+// funções do núcleo: número de quarto único, CPF único, quarto livre e sem conflito com a agenda.
+// Exportação: uma linha por registro escrita pelo BufferSaida, em CSV (mesmas colunas da importação) ou JSON.
+// Colunas (separador ',', campo com vírgula ou aspas vai entre aspas, cabeçalho opcional na importação):
+//   quartos:  numero,tipo,preco_diaria,status          (status 0/1/2 do cadastro, opcional)
+//   hospedes: cpf,nome,telefone                        (IDs atribuídos na ordem do arquivo)
+//   reservas: cpf,quarto,checkin,checkout,status,valor (status Ativa/Concluida/Cancelada, opcional; valor é
+//             recalculado pelas tarifas). Exportadas em ordem de ID: a importação reproduz os mesmos IDs.
+const char *nomes_tabelas[NUM_TABELAS_CSV] = {"quartos", "hospedes", "reservas"};
+const char *cabecalhos_csv[NUM_TABELAS_CSV] = { // Primeira linha do CSV exportado
+    "numero,tipo,preco_diaria,status", "cpf,nome,telefone", "cpf,quarto,checkin,checkout,status,valor"};
+
+int tabela_csv_por_nome(const char *nome) { // TABELA_QUARTOS/HOSPEDES/RESERVAS, ou -1
+    for (int t = 0; t < NUM_TABELAS_CSV; t++) {
+        if (strcmp(nome, nomes_tabelas[t]) == 0) return t;
+    }
+    return -1;
+}
+
+int separar_csv(char *linha, char **campos) { // Divide uma linha CSV (in-place); -1 se mal formada
+    int quantidade = 0;
+    char *c = linha;
+    while (1) {
+        if (quantidade == MAX_CAMPOS_CSV) return -1; // Campos demais
+        char *destino = c;                 // Campo é reescrito no lugar (aspas duplas viram uma)
+        campos[quantidade++] = c;
+        if (*c == '"') {                   // Campo entre aspas
+            c++;
+            while (*c != '"' || c[1] == '"') {
+                if (*c == '\0') return -1; // Aspas sem fechamento
+                if (*c == '"') c++;        // "" -> "
+                *destino++ = *c++;
+            }
+            c++;
+            if (*c != ',' && *c != '\0') return -1; // Lixo depois das aspas
+        } else {
+            while (*c != ',' && *c != '\0') *destino++ = *c++;
+        }
+        int ultimo = (*c == '\0');
+        *destino = '\0';
+        if (ultimo) return quantidade;
+        c++;
+    }
+}
+
+int ler_status_reserva(const char *texto, int *status) { // "Ativa"/"Concluida"/"Cancelada" ou 0/1/2
+    for (int s = ATIVA; s <= CANCELADA; s++) {
+        if (strcmp(texto, descrever_status_reserva(s)) == 0) {
+            *status = s;
+            return 1;
+        }
+    }
+    return ler_inteiro(texto, status) && *status >= ATIVA && *status <= CANCELADA;
+}
+
+int converter_linha_csv(int tabela, char *linha, LinhaImportada *destino) { // Campos -> registro; retorna o código
+    char *campos[MAX_CAMPOS_CSV];
+    int n = separar_csv(linha, campos);
+    memset(&destino->dados, 0, sizeof(destino->dados));
+    if (tabela == TABELA_QUARTOS) {
+        Quarto *q = &destino->dados.quarto;
+        q->status = LIVRE;                 // Status é opcional
+        if ((n != 3 && n != 4) || !ler_inteiro(campos[0], &q->numero) || strlen(campos[1]) >= TAM_TIPO ||
+            !ler_preco(campos[2], &q->preco_diaria) || (n == 4 && !ler_inteiro(campos[3], &q->status))) {
+            return ERRO_PARAMETRO_INVALIDO;
+        }
+        strcpy(q->tipo, campos[1]);
+    } else if (tabela == TABELA_HOSPEDES) {
+        HospedeArquivo *h = &destino->dados.hospede;
+        if (n != 3 || strlen(campos[0]) >= TAM_CPF || strlen(campos[1]) >= TAM_NOME ||
+            strlen(campos[2]) >= TAM_TELEFONE) {
+            return ERRO_PARAMETRO_INVALIDO;
+        }
+        strcpy(h->cpf, campos[0]);
+        strcpy(h->nome, campos[1]);
+        strcpy(h->telefone, campos[2]);
+    } else {
+        ReservaImportada *r = &destino->dados.reserva;
+        r->status_reserva = ATIVA;         // Status é opcional; o valor (6ª coluna) é ignorado
+        if (n < 4 || n > 6 || strlen(campos[0]) >= TAM_CPF || !ler_inteiro(campos[1], &r->numero_quarto) ||
+            (n >= 5 && !ler_status_reserva(campos[4], &r->status_reserva))) {
+            return ERRO_PARAMETRO_INVALIDO;
+        }
+        strcpy(r->cpf, campos[0]);
+        r->dia_checkin = converter_data_em_dias(campos[2]);
+        r->dia_checkout = converter_data_em_dias(campos[3]);
+        if (r->dia_checkin == DATA_INVALIDA || r->dia_checkout == DATA_INVALIDA || r->dia_checkout <= r->dia_checkin) {
+            return ERRO_DATAS_INVALIDAS;
+        }
+    }
+    return OPERACAO_OK;
+}
+
+typedef struct {                        // Contexto da conversão paralela de uma janela do CSV
+    int tabela;                          // TABELA_QUARTOS/HOSPEDES/RESERVAS
+    char *dados;                         // Janela (linhas inteiras)
+    size_t limites[MAX_THREADS * BLOCOS_POR_THREAD + 1]; // Bloco b = dados[limites[b], limites[b+1])
+    BlocoImportacao blocos[MAX_THREADS * BLOCOS_POR_THREAD];
+} ConversaoCsv;
+
+void converter_blocos_csv(int inicio, int fim, int bloco, void *contexto) { // Converte as linhas de cada bloco
+    ConversaoCsv *conversao = (ConversaoCsv *)contexto;
+    (void)bloco;
+    for (int b = inicio; b < fim; b++) {
+        BlocoImportacao *destino = &conversao->blocos[b];
+        char *linha = conversao->dados + conversao->limites[b];
+        char *limite = conversao->dados + conversao->limites[b + 1];
+        destino->quantidade = 0;
+        destino->linhas_lidas = 0;
+        while (linha < limite) {
+            char *quebra = memchr(linha, '\n', limite - linha);
+            if (quebra == NULL) quebra = limite; // Última linha do arquivo, sem '\n' (há espaço para o '\0')
+            *quebra = '\0';
+            if (quebra > linha && quebra[-1] == '\r') quebra[-1] = '\0'; // Aceita quebras de linha CRLF
+            destino->linhas_lidas++;
+            if (*linha != '\0') {          // Linhas vazias só contam na numeração
+                destino->linhas = (LinhaImportada *)crescer_vetor(destino->linhas, &destino->capacidade,
+                                                                  destino->quantidade + 1, sizeof(LinhaImportada),
+                                                                  "importacao");
+                LinhaImportada *registro = &destino->linhas[destino->quantidade++];
+                registro->linha = destino->linhas_lidas;
+                registro->codigo = converter_linha_csv(conversao->tabela, linha, registro);
+            }
+            linha = quebra + 1;
+        }
+    }
+}
+
+int importar_registro(int tabela, const LinhaImportada *registro) { // Insere um registro já convertido pelo núcleo
+    if (registro->codigo != OPERACAO_OK) return registro->codigo;
+    if (tabela == TABELA_QUARTOS) {
+        const Quarto *q = &registro->dados.quarto;
+        return inserir_quarto(q->numero, q->tipo, q->preco_diaria, q->status);
+    }
+    if (tabela == TABELA_HOSPEDES) {
+        const HospedeArquivo *h = &registro->dados.hospede;
+        return inserir_hospede(h->cpf, h->nome, h->telefone, NULL);
+    }
+    const ReservaImportada *r = &registro->dados.reserva;
+    int indice_hospede = buscar_hospede_por_cpf(r->cpf);
+    if (indice_hospede == -1) return ERRO_HOSPEDE_INEXISTENTE;
+    int indice_quarto = buscar_quarto_por_numero(r->numero_quarto);
+    if (indice_quarto == -1) return ERRO_QUARTO_INEXISTENTE;
+    if (!quarto_disponivel_indice(indice_quarto, r->dia_checkin, r->dia_checkout)) { // Datas sobrepõem outra reserva
+        return ERRO_QUARTO_INDISPONIVEL;
+    }
+    int id;
+    int codigo = criar_reserva(indice_hospede, r->numero_quarto, r->dia_checkin, r->dia_checkout, &id, NULL);
+    if (codigo == OPERACAO_OK && r->status_reserva != ATIVA) { // Reserva já encerrada: entra direto no arquivo
+        codigo = alterar_status_reserva(id, r->status_reserva);
+    }
+    return codigo;
+}
+
+int importar_csv(int tabela, const char *caminho, BufferSaida *saida, int *inseridos, int *rejeitados) {
+    // Importa o CSV 'caminho' na tabela; as primeiras linhas rejeitadas são listadas em 'saida'
+    FILE *arquivo = fopen(caminho, "rb");
+    if (arquivo == NULL) {
+        return ERRO_ARQUIVO;
+    }
+    char *janela = (char *)malloc(TAM_JANELA_IMPORTACAO + 1); // +1 para o '\0' da última linha
+    ConversaoCsv *conversao = (ConversaoCsv *)calloc(1, sizeof(ConversaoCsv));
+    if (janela == NULL || conversao == NULL) { // Verifica falha de alocação
+        fprintf(stderr, "Erro fatal: Nao foi possivel alocar memoria para a importacao!\n");
+        exit(1);
+    }
+    conversao->tabela = tabela;
+    *inseridos = *rejeitados = 0;
+    size_t usado = 0;                      // Bytes lidos e ainda não convertidos
+    int linhas_anteriores = 0;             // Linhas das janelas já processadas (numeração no arquivo)
+    int primeira_janela = 1;
+    int fim_arquivo = 0;
+    int descartando = 0;                   // 1 enquanto pula o resto de uma linha maior que a janela
+    while (!fim_arquivo) {
+        usado += fread(janela + usado, 1, TAM_JANELA_IMPORTACAO - usado, arquivo);
+        fim_arquivo = (usado < TAM_JANELA_IMPORTACAO); // Leitura curta: fim do arquivo (ou erro)
+        if (descartando) {                 // Descarta até o próximo '\n' (inclusive)
+            char *quebra = memchr(janela, '\n', usado);
+            size_t descartados = (quebra != NULL) ? (size_t)(quebra - janela) + 1 : usado;
+            memmove(janela, janela + descartados, usado - descartados);
+            usado -= descartados;
+            descartando = (quebra == NULL);
+            if (!fim_arquivo) continue;    // Completa a janela antes de converter
+        }
+        size_t tamanho = usado;            // Converte só até a última linha completa
+        if (!fim_arquivo) {
+            while (tamanho > 0 && janela[tamanho - 1] != '\n') tamanho--;
+            if (tamanho == 0) {            // Linha maior que a janela: rejeitada uma vez, sem converter nenhum pedaço
+                if ((*rejeitados)++ < MAX_REJEICOES_EXIBIDAS) {
+                    saida_printf(saida, "REJEITADA %d %s\n", linhas_anteriores + 1,
+                                 descrever_erro(ERRO_PARAMETRO_INVALIDO));
+                }
+                linhas_anteriores++;
+                primeira_janela = 0;
+                usado = 0;
+                descartando = 1;
+                continue;
+            }
+        }
+        size_t inicio = 0;
+        if (primeira_janela) {             // Cabeçalho (linha começando pelo nome da primeira coluna) é pulado
+            const char *cabecalho = cabecalhos_csv[tabela];
+            size_t nome = strchr(cabecalho, ',') - cabecalho + 1; // "numero," ou "cpf,"
+            if (tamanho >= nome && strncmp(janela, cabecalho, nome) == 0) {
+                char *quebra = memchr(janela, '\n', tamanho);
+                inicio = (quebra != NULL) ? (size_t)(quebra - janela) + 1 : tamanho;
+                linhas_anteriores = 1;
+            }
+            primeira_janela = 0;
+        }
+        if (tamanho == usado) janela[tamanho] = '\0'; // Última linha sem '\n' (o resto da janela não é tocado)
+
+        conversao->dados = janela + inicio;
+        size_t bytes = tamanho - inicio;
+        int num_blocos = planejar_blocos((int)bytes, MIN_BYTES_POR_BLOCO);
+        conversao->limites[0] = 0;
+        for (int b = 1; b < num_blocos; b++) { // Cada bloco começa no início de uma linha
+            size_t p = bytes * b / num_blocos;
+            if (p < conversao->limites[b - 1]) p = conversao->limites[b - 1];
+            char *quebra = memchr(conversao->dados + p, '\n', bytes - p);
+            conversao->limites[b] = (quebra != NULL) ? (size_t)(quebra - conversao->dados) + 1 : bytes;
+        }
+        conversao->limites[num_blocos] = bytes;
+        executar_paralelo(num_blocos, num_blocos, converter_blocos_csv, conversao);
+
+        int validos = 0;                   // Reserva espaço de uma vez para os registros bem formados
+        for (int b = 0; b < num_blocos; b++) {
+            for (int k = 0; k < conversao->blocos[b].quantidade; k++) {
+                validos += (conversao->blocos[b].linhas[k].codigo == OPERACAO_OK);
+            }
+        }
+        if (tabela == TABELA_QUARTOS) reservar_quartos(validos);
+        else if (tabela == TABELA_HOSPEDES) reservar_hospedes(validos);
+
+        for (int b = 0; b < num_blocos; b++) { // Inserção sequencial, na ordem do arquivo
+            BlocoImportacao *bloco = &conversao->blocos[b];
+            for (int k = 0; k < bloco->quantidade; k++) {
+                int codigo = importar_registro(tabela, &bloco->linhas[k]);
+                if (codigo == OPERACAO_OK) {
+                    (*inseridos)++;
+                } else if ((*rejeitados)++ < MAX_REJEICOES_EXIBIDAS) {
+                    saida_printf(saida, "REJEITADA %d %s\n", linhas_anteriores + bloco->linhas[k].linha,
+                                 descrever_erro(codigo));
+                }
+            }
+            linhas_anteriores += bloco->linhas_lidas;
+        }
+        memmove(janela, janela + tamanho, usado - tamanho); // Linha incompleta vai para a próxima janela
+        usado -= tamanho;
+    }
+    fclose(arquivo);
+    for (int b = 0; b < MAX_THREADS * BLOCOS_POR_THREAD; b++) {
+        free(conversao->blocos[b].linhas);
+    }
+    free(conversao);
+    free(janela);
+    return OPERACAO_OK;
+}
+
+void escrever_texto_csv(BufferSaida *saida, const char *texto) { // Campo CSV (entre aspas se precisar)
+    if (strpbrk(texto, ",\"\r\n") == NULL) {
+        saida_escrever(saida, texto, strlen(texto));
         return;
     }
+    saida_escrever(saida, "\"", 1);
+    for (const char *c = texto; *c != '\0'; c++) {
+        if (*c == '"') saida_escrever(saida, "\"", 1); // Aspas internas são duplicadas
+        saida_escrever(saida, c, 1);
+    }
+    saida_escrever(saida, "\"", 1);
+}
 
-    Hospede *h = &hospedes_hotel[index];   // Ponteiro para o hóspede encontrado
+void escrever_texto_json(BufferSaida *saida, const char *texto) { // String JSON com escapes
+    saida_escrever(saida, "\"", 1);
+    for (const unsigned char *c = (const unsigned char *)texto; *c != '\0'; c++) {
+        if (*c == '"' || *c == '\\') {
+            saida_escrever(saida, "\\", 1);
+            saida_escrever(saida, (const char *)c, 1);
+        } else if (*c < 0x20) {            // Caracteres de controle
+            saida_printf(saida, "\\u%04x", *c);
+        } else {
+            saida_escrever(saida, (const char *)c, 1);
+        }
+    }
+    saida_escrever(saida, "\"", 1);
+}
 
-    printf("\nHistorico de Reservas de %s (CPF %s)\n",
-           h->nome, h->cpf);               // Cabeçalho com nome e CPF
+void exportar_quartos(BufferSaida *saida, int json) { // Uma linha por quarto, na ordem de cadastro
+    Hotel *hotel = hotel_atual;
+    for (int i = 0; i < hotel->contador_quartos; i++) {
+        const Quarto *q = &hotel->quartos_hotel[i];
+        if (json) {
+            saida_printf(saida, "%s{\"numero\":%d,\"tipo\":", (i > 0) ? ",\n" : "", q->numero);
+            escrever_texto_json(saida, q->tipo);
+            saida_printf(saida, ",\"preco_diaria\":%.2f,\"status\":%d}", q->preco_diaria, q->status);
+        } else {
+            saida_printf(saida, "%d,", q->numero);
+            escrever_texto_csv(saida, q->tipo);
+            saida_printf(saida, ",%.2f,%d\n", q->preco_diaria, q->status);
+        }
+    }
+}
 
-    if (h->num_reservas_historico == 0) {  // Se não há histórico
-        printf("Nenhuma reserva concluida/cancelada ainda.\n");
+void exportar_hospedes(BufferSaida *saida, int json) { // Uma linha por hóspede, na ordem dos IDs
+    char cpf[TAM_CPF], telefone[TAM_TELEFONE]; // Só dígitos: dispensam aspas e escapes
+    for (int i = 0; i < contador_hospedes; i++) {
+        const Hospede *h = &hospedes_hotel[i];
+        texto_cpf(h->cpf, cpf);
+        texto_telefone(h->telefone, telefone);
+        if (json) {
+            saida_printf(saida, "%s{\"id\":%d,\"cpf\":\"%s\",\"nome\":", (i > 0) ? ",\n" : "", h->id_hospede, cpf);
+            escrever_texto_json(saida, nome_hospede(h));
+            saida_printf(saida, ",\"telefone\":\"%s\"}", telefone);
+        } else {
+            saida_printf(saida, "%s,", cpf);
+            escrever_texto_csv(saida, nome_hospede(h));
+            saida_printf(saida, ",%s\n", telefone);
+        }
+    }
+}
+
+int exportar_reservas(BufferSaida *saida, int json) { // Ativas e arquivadas, na ordem dos IDs; retorna quantas escreveu
+    Hotel *hotel = hotel_atual;
+    char checkin_str[TAM_DATA], checkout_str[TAM_DATA], cpf[TAM_CPF];
+    VistaReservas *vista = vista_reservas_obter(); // Versão consistente, sem travar as reservas durante a escrita
+    int total = vista->num_ativas + vista->num_arquivadas, escritas = 0;
+    int *posicoes = (int *)malloc((total + 1) * sizeof(int)); // ID - 1 -> posição na vista: >= 0 ativa, -2-p no arquivo
+    if (posicoes == NULL) {
+        fprintf(stderr, "Erro fatal: Nao foi possivel alocar memoria para a exportacao!\n");
+        exit(1);
+    }
+    for (int i = 0; i < total; i++) posicoes[i] = -1; // -1 = ID sem reserva (não acontece com as tabelas íntegras)
+    for (int i = 0; i < vista->num_ativas; i++) { // IDs são densos: cada um de 1 a total está em uma das tabelas
+        int id = vista->ativas.id_reserva[i];
+        if (id >= 1 && id <= total) posicoes[id - 1] = i;
+    }
+    for (int i = 0; i < vista->num_arquivadas; i++) {
+        int id = hotel->reservas_arquivadas.id_reserva[i];
+        if (id >= 1 && id <= total) posicoes[id - 1] = -2 - i;
+    }
+    for (int id = 1; id <= total; id++) {
+        int p = posicoes[id - 1];
+        Reserva reserva;
+        if (p == -1) continue;             // Lacuna nos IDs: nada a exportar
+        reserva_ler((p >= 0) ? &vista->ativas : &hotel->reservas_arquivadas, (p >= 0) ? p : -2 - p, &reserva);
+        int indice_hospede = buscar_hospede_por_id(reserva.id_hospede);
+        if (indice_hospede == -1) continue; // Sem o hóspede não há CPF: a reserva fica de fora (e da contagem)
+        texto_cpf(hospedes_hotel[indice_hospede].cpf, cpf);
+        formatar_data(reserva.dia_checkin, checkin_str);
+        formatar_data(reserva.dia_checkout, checkout_str);
+        if (json) {
+            saida_printf(saida, "%s{\"id\":%d,\"cpf\":", (escritas++ > 0) ? ",\n" : "", id);
+            escrever_texto_json(saida, cpf);
+            saida_printf(saida, ",\"quarto\":%d,\"checkin\":\"%s\",\"checkout\":\"%s\",\"status\":\"%s\",\"valor\":%lld.%02lld}",
+                         reserva.numero_quarto, checkin_str, checkout_str, descrever_status_reserva(reserva.status_reserva),
+                         reserva.valor_centavos / 100, reserva.valor_centavos % 100);
+        } else {
+            escrever_texto_csv(saida, cpf);
+            saida_printf(saida, ",%d,%s,%s,%s,%lld.%02lld\n", reserva.numero_quarto, checkin_str, checkout_str,
+                         descrever_status_reserva(reserva.status_reserva),
+                         reserva.valor_centavos / 100, reserva.valor_centavos % 100);
+            escritas++;
+        }
+    }
+    free(posicoes);
+    vista_reservas_soltar(vista);
+    return escritas;
+}
+
+int exportar_tabela(int tabela, int json, const char *caminho, int *exportados) { // Grava a tabela em CSV ou JSON
+    FILE *arquivo = fopen(caminho, "wb");
+    if (arquivo == NULL) {
+        return ERRO_ARQUIVO;
+    }
+    BufferSaida *saida = (BufferSaida *)malloc(sizeof(BufferSaida)); // Um por exportação: no servidor, várias rodam juntas
+    if (saida == NULL) {
+        fprintf(stderr, "Erro fatal: Nao foi possivel alocar memoria para a exportacao!\n");
+        exit(1);
+    }
+    saida->arquivo = arquivo;
+    saida->usado = 0;
+    if (json) {
+        saida_escrever(saida, "[\n", 2);
+    } else {
+        saida_printf(saida, "%s\n", cabecalhos_csv[tabela]);
+    }
+    if (tabela == TABELA_QUARTOS) {
+        exportar_quartos(saida, json);
+        *exportados = hotel_atual->contador_quartos;
+    } else if (tabela == TABELA_HOSPEDES) {
+        exportar_hospedes(saida, json);
+        *exportados = contador_hospedes;
+    } else {
+        *exportados = exportar_reservas(saida, json);
+    }
+    if (json) saida_escrever(saida, "\n]\n", 3);
+    saida_descarregar(saida);
+    int falhou = ferror(arquivo);
+    if (fclose(arquivo) != 0) falhou = 1;
+    free(saida);
+    return falhou ? ERRO_ARQUIVO : OPERACAO_OK;
+}
+
+void importar_exportar_menu() {            // Opção de menu: importação CSV e exportação CSV/JSON
+    static BufferSaida saida;              // Estático: buffer grande demais para a pilha
+    int acao = 0, tabela = 0, formato = 1, quantidade = 0, rejeitados = 0;
+    char caminho[256];                     // Caminho do arquivo
+    printf("1 - Importar CSV\n");
+    printf("2 - Exportar\n");
+    printf("Escolha uma opcao: ");
+    scanf("%d", &acao);
+    if (acao != 1 && acao != 2) {
+        printf("Opcao invalida.\n");
+        return;
+    }
+    printf("Tabela (1 - Quartos, 2 - Hospedes, 3 - Reservas): ");
+    scanf("%d", &tabela);
+    if (tabela < 1 || tabela > NUM_TABELAS_CSV) {
+        printf("Opcao invalida.\n");
         return;
     }
+    if (acao == 2) {
+        printf("Formato (1 - CSV, 2 - JSON): ");
+        scanf("%d", &formato);
+    }
+    printf("Digite o caminho do arquivo: ");
+    scanf("%255s", caminho);
+    if (acao == 1) {
+        saida.arquivo = stdout;
+        saida.usado = 0;
+        if (importar_csv(tabela - 1, caminho, &saida, &quantidade, &rejeitados) != OPERACAO_OK) {
+            printf("ERRO: Nao foi possivel abrir %s.\n", caminho);
+            return;
+        }
+        saida_descarregar(&saida);         // Primeiras linhas rejeitadas, com o motivo
+        printf("%d registros importados, %d linhas rejeitadas.\n", quantidade, rejeitados);
+    } else if (exportar_tabela(tabela - 1, formato == 2, caminho, &quantidade) == OPERACAO_OK) {
+        printf("%d registros exportados para %s.\n", quantidade, caminho);
+    } else {
+        printf("ERRO: Nao foi possivel gravar %s.\n", caminho);
+    }
+}
+
+//ALOCACAO DE GRUPOS (RESERVAS EM LOTE POR TIPO)
+// Um grupo é um CSV cpf,tipo,checkin,checkout (cabeçalho opcional): cada linha pede um quarto do tipo no
+// período, sem escolher o número. Os pedidos são atendidos por tipo e check-out (o que termina antes vai
+// primeiro), como no escalonamento de intervalos em k máquinas: cada um vai para o quarto do tipo, em
+// operação e sem conflito na agenda, que deixa a menor folga até as reservas e bloqueios vizinhos (best
+// fit); no empate, o mais barato. Com as agendas vazias isso atende o máximo de pedidos possível. Um quarto
+// vazio tem folga aberta dos dois lados, então só é usado quando nenhum quarto já reservado comporta a estadia.
+// Pedidos que não couberem são devolvidos com o motivo.
+typedef struct {                        // Um pedido do grupo (linha do CSV) e o resultado da alocação
+    int linha;                           // Linha no arquivo (numeração da saída)
+    int codigo;                          // OPERACAO_OK, ou o motivo de o pedido não ter sido alocado
+    int indice_hospede;                  // Hóspede do pedido
+    int id_tipo;                         // Tipo de quarto pedido (ID do dicionário de tipos)
+    long dia_checkin;
+    long dia_checkout;
+    int numero_quarto;                   // Quarto escolhido
+    int id_reserva;                      // Reserva criada
+    long long valor_centavos;            // Valor da estadia
+} PedidoGrupo;
+
+typedef struct {                        // Contexto da escolha paralela do quarto de um pedido
+    const int *indices;                  // Quartos do tipo, do mais barato ao mais caro
+    long dia_checkin;
+    long dia_checkout;
+    int melhor_folga[MAX_THREADS * BLOCOS_POR_THREAD]; // Por bloco: menor folga encontrada
+    int melhor_posicao[MAX_THREADS * BLOCOS_POR_THREAD]; // E a posição dela em 'indices' (-1 = nenhum quarto livre)
+} EscolhaQuarto;
 
-    for (int i = 0; i < h->num_reservas_historico; i++) { // Percorre IDs no histórico
-        int id = h->historico_ids_reservas[i]; // Recupera ID da reserva
-        printf("- Reserva ID %d\n", id);     // Imprime cada ID
+int folga_na_agenda(const AgendaQuarto *agenda, long checkin, long checkout) { // Noites vagas ao redor da estadia; -1 se conflita
+    int p = agenda_contar_antes(agenda, checkout); // Mesma busca de agenda_conflita
+    if (p > 0 && agenda->intervalos[p-1].max_checkout > checkin) return -1;
+    long antes = (p > 0) ? checkin - agenda->intervalos[p-1].max_checkout : FOLGA_ABERTA_GRUPO;
+    long depois = (p < agenda->num_intervalos) ? agenda->intervalos[p].checkin - checkout : FOLGA_ABERTA_GRUPO;
+    if (antes > FOLGA_ABERTA_GRUPO) antes = FOLGA_ABERTA_GRUPO; // Vizinha distante vale como lado aberto
+    if (depois > FOLGA_ABERTA_GRUPO) depois = FOLGA_ABERTA_GRUPO;
+    return (int)(antes + depois);
+}
+
+void escolher_quarto_blocos(int inicio, int fim, int bloco, void *contexto) { // Melhor quarto entre as posições [inicio, fim)
+    Hotel *hotel = hotel_atual;
+    EscolhaQuarto *escolha = (EscolhaQuarto *)contexto;
+    int melhor_folga = -1, melhor_posicao = -1;
+    for (int k = inicio; k < fim && melhor_folga != 0; k++) { // Folga zero não tem como melhorar
+        int i = escolha->indices[k];
+        if (hotel->quartos_hotel[i].status != LIVRE) continue; // Fora de operação no cadastro
+        int folga = folga_na_agenda(&hotel->agendas_quartos[i], escolha->dia_checkin, escolha->dia_checkout);
+        if (folga >= 0 && (melhor_posicao == -1 || folga < melhor_folga)) { // Empate fica com o mais barato
+            melhor_folga = folga;
+            melhor_posicao = k;
+        }
     }
+    escolha->melhor_folga[bloco] = melhor_folga;
+    escolha->melhor_posicao[bloco] = melhor_posicao;
 }
 
-int conflito_datas(const char* data_in1, const char* data_out1,
-                    const char* data_in2, const char* data_out2)
-{                                         // Verifica se dois intervalos [in1,out1) e [in2,out2) se sobrepõem
-    long in1 = contar_dias(
-        atoi(data_in1), atoi(data_in1+3), atoi(data_in1+6)
-    );                                     // Converte data_in1 para dias (atoi interpreta substring)
-    long out1 = contar_dias(
-        atoi(data_out1), atoi(data_out1+3), atoi(data_out1+6)
-    );                                     // Converte data_out1 para dias
-    long in2 = contar_dias(
-        atoi(data_in2), atoi(data_in2+3), atoi(data_in2+6)
-    );                                     // Converte data_in2
-    long out2 = contar_dias(
-        atoi(data_out2), atoi(data_out2+3), atoi(data_out2+6)
-    );                                     // Converte data_out2
-    return (in1 < out2 && out1 > in2);    // Retorna true se houver sobreposição
+int comparar_pedidos_alocacao(const void *a, const void *b) { // Tipo, check-out, estadia mais curta, linha (qsort)
+    const PedidoGrupo *x = (const PedidoGrupo *)a, *y = (const PedidoGrupo *)b;
+    if (x->id_tipo != y->id_tipo) return (x->id_tipo > y->id_tipo) - (x->id_tipo < y->id_tipo);
+    if (x->dia_checkout != y->dia_checkout) return (x->dia_checkout > y->dia_checkout) - (x->dia_checkout < y->dia_checkout);
+    if (x->dia_checkin != y->dia_checkin) return (x->dia_checkin < y->dia_checkin) - (x->dia_checkin > y->dia_checkin);
+    return (x->linha > y->linha) - (x->linha < y->linha);
 }
 
-int quarto_disponivel_periodo(int numero_quarto, const char* data_in, const char* data_out)
-{                                         // Retorna 1 se quarto estiver disponível no período, 0 caso contrário
-    for (int i = 0; i < contador_reservas; i++) { // Percorre todas as reservas
+int comparar_pedidos_linha(const void *a, const void *b) { // Ordem do arquivo (qsort)
+    const PedidoGrupo *x = (const PedidoGrupo *)a, *y = (const PedidoGrupo *)b;
+    return (x->linha > y->linha) - (x->linha < y->linha);
+}
 
-        if (reservas_hotel[i].numero_quarto != numero_quarto) { // Se reserva é de outro quarto, ignora
-            continue; // não é o quarto procurado
+int alocar_grupo(PedidoGrupo *pedidos, int quantidade) { // Aloca os pedidos com codigo OPERACAO_OK; retorna quantos couberam
+    // Exige acesso exclusivo (cresce as reservas e ordena as listas de preço); 'pedidos' volta na ordem do arquivo
+    Hotel *hotel = hotel_atual;
+    MEDIR_INICIO(MEDIDA_ALOCAR_GRUPO);
+    int alocados = 0;
+    EscolhaQuarto escolha;
+    reservar_reservas(quantidade);         // Espaço para o grupo inteiro de uma vez
+    qsort(pedidos, quantidade, sizeof(PedidoGrupo), comparar_pedidos_alocacao);
+    for (int n = 0; n < quantidade; n++) {
+        PedidoGrupo *pedido = &pedidos[n];
+        if (pedido->codigo != OPERACAO_OK) continue; // Linha já rejeitada na leitura
+        if (pedido->id_tipo >= hotel->capacidade_indices_preco) { // Tipo sem quartos neste hotel
+            pedido->codigo = ERRO_QUARTO_INEXISTENTE;
+            continue;
         }
+        IndicePrecoTipo *indice = &hotel->indices_preco[pedido->id_tipo];
+        if (!indice->ordenado) {           // Empates de folga ficam com o mais barato: a lista precisa estar em ordem
+            qsort(indice->indices, indice->quantidade, sizeof(int), comparar_quartos_preco);
+            indice->ordenado = 1;
+        }
+        escolha.indices = indice->indices;
+        escolha.dia_checkin = pedido->dia_checkin;
+        escolha.dia_checkout = pedido->dia_checkout;
+        int num_blocos = planejar_blocos(indice->quantidade, MIN_QUARTOS_POR_BLOCO);
+        executar_paralelo(indice->quantidade, num_blocos, escolher_quarto_blocos, &escolha);
+        int melhor = -1, menor_folga = 0;
+        for (int b = 0; b < num_blocos; b++) { // Blocos em ordem: no empate vence a posição menor (mais barata)
+            if (escolha.melhor_posicao[b] != -1 && (melhor == -1 || escolha.melhor_folga[b] < menor_folga)) {
+                melhor = escolha.melhor_posicao[b];
+                menor_folga = escolha.melhor_folga[b];
+            }
+        }
+        if (melhor == -1) {                // Nenhum quarto do tipo comporta o período
+            pedido->codigo = ERRO_QUARTO_INDISPONIVEL;
+            continue;
+        }
+        pedido->numero_quarto = hotel->quartos_hotel[indice->indices[melhor]].numero;
+        pedido->codigo = registrar_nova_reserva(pedido->indice_hospede, pedido->numero_quarto, pedido->dia_checkin,
+                                                pedido->dia_checkout, &pedido->id_reserva, &pedido->valor_centavos);
+        if (pedido->codigo == OPERACAO_OK) alocados++;
+    }
+    qsort(pedidos, quantidade, sizeof(PedidoGrupo), comparar_pedidos_linha);
+    MEDIR_FIM(MEDIDA_ALOCAR_GRUPO, quantidade); // Pedidos do grupo
+    return alocados;
+}
+
+int ler_pedidos_grupo(const char *caminho, PedidoGrupo **pedidos, int *quantidade) { // Lê e valida o CSV do grupo
+    FILE *arquivo = fopen(caminho, "rb");
+    if (arquivo == NULL) {
+        return ERRO_ARQUIVO;
+    }
+    LeitorLinhas *leitor = (LeitorLinhas *)malloc(sizeof(LeitorLinhas)); // Grande demais para a pilha
+    if (leitor == NULL) {                  // Verifica falha de alocação
+        fprintf(stderr, "Erro fatal: Nao foi possivel alocar memoria para o grupo!\n");
+        exit(1);
+    }
+    leitor->arquivo = arquivo;
+    leitor->inicio = leitor->fim = 0;
+    leitor->fim_arquivo = 0;
+    leitor->descritor = -1;
+    int capacidade = 0, numero_linha = 0;
+    char *linha;
+    *pedidos = NULL;
+    *quantidade = 0;
+    while ((linha = ler_linha(leitor)) != NULL) {
+        numero_linha++;
+        if (!leitor->linha_longa && (*linha == '\0' || (numero_linha == 1 && strncmp(linha, "cpf,tipo,", 9) == 0))) {
+            continue;                      // Vazia ou cabeçalho
+        }
+        *pedidos = (PedidoGrupo *)crescer_vetor(*pedidos, &capacidade, *quantidade + 1, sizeof(PedidoGrupo), "grupo");
+        PedidoGrupo *pedido = &(*pedidos)[(*quantidade)++];
+        char *campos[MAX_CAMPOS_CSV];
+        int n = separar_csv(linha, campos);
+        memset(pedido, 0, sizeof(PedidoGrupo));
+        pedido->linha = numero_linha;
+        pedido->codigo = OPERACAO_OK;
+        if (n != 4 || leitor->linha_longa) { // Linha longa demais chega vazia: pedido inválido
+            pedido->codigo = ERRO_PARAMETRO_INVALIDO;
+            continue;
+        }
+        pedido->indice_hospede = buscar_hospede_por_cpf(campos[0]);
+        pedido->id_tipo = buscar_tipo_quarto(campos[1]);
+        pedido->dia_checkin = converter_data_em_dias(campos[2]);
+        pedido->dia_checkout = converter_data_em_dias(campos[3]);
+        if (pedido->indice_hospede == -1) {
+            pedido->codigo = ERRO_HOSPEDE_INEXISTENTE;
+        } else if (pedido->id_tipo == -1) { // Nenhum quarto cadastrado com esse tipo
+            pedido->codigo = ERRO_QUARTO_INEXISTENTE;
+        } else if (pedido->dia_checkin == DATA_INVALIDA || pedido->dia_checkout == DATA_INVALIDA ||
+                   pedido->dia_checkout <= pedido->dia_checkin) {
+            pedido->codigo = ERRO_DATAS_INVALIDAS;
+        }
+    }
+    fclose(arquivo);
+    free(leitor);
+    return OPERACAO_OK;
+}
 
-        if (reservas_hotel[i].status_reserva == CANCELADA) { // Reservas canceladas não bloqueiam
-            continue; // reservas canceladas não bloqueiam o quarto
+int alocar_grupo_arquivo(const char *caminho, BufferSaida *saida, int *alocados, int *nao_alocados) {
+    // Aloca o grupo do CSV 'caminho'; escreve em 'saida' uma linha por pedido, na ordem do arquivo
+    PedidoGrupo *pedidos;
+    int quantidade;
+    int codigo = ler_pedidos_grupo(caminho, &pedidos, &quantidade);
+    if (codigo != OPERACAO_OK) return codigo;
+    *alocados = alocar_grupo(pedidos, quantidade);
+    *nao_alocados = quantidade - *alocados;
+    for (int n = 0; n < quantidade; n++) {
+        const PedidoGrupo *pedido = &pedidos[n];
+        if (pedido->codigo == OPERACAO_OK) { // Linha, reserva criada, quarto e valor
+            saida_printf(saida, "ALOCADA %d %d %d %lld.%02lld\n", pedido->linha, pedido->id_reserva,
+                         pedido->numero_quarto, pedido->valor_centavos / 100, pedido->valor_centavos % 100);
+        } else {
+            saida_printf(saida, "NAO_ALOCADA %d %s\n", pedido->linha, descrever_erro(pedido->codigo));
         }
+    }
+    free(pedidos);
+    return OPERACAO_OK;
+}
 
-        // Se datas conflitam → o quarto NÃO está disponível
-        if (conflito_datas(data_in, data_out,
-                            reservas_hotel[i].data_checkin,
-                            reservas_hotel[i].data_checkout)) 
-        {
-            return 0; // Indisponível (conflito encontrado)
+void alocar_grupo_menu() {                 // Opção de menu: aloca um grupo de reservas lido de um CSV
+    static BufferSaida saida;              // Estático: buffer grande demais para a pilha
+    char caminho[256];                     // Caminho do arquivo
+    int alocados = 0, nao_alocados = 0;
+    printf("Arquivo do grupo (CSV cpf,tipo,checkin,checkout): ");
+    scanf("%255s", caminho);
+    saida.arquivo = stdout;
+    saida.usado = 0;
+    if (alocar_grupo_arquivo(caminho, &saida, &alocados, &nao_alocados) != OPERACAO_OK) {
+        printf("ERRO: Nao foi possivel abrir %s.\n", caminho);
+        return;
+    }
+    saida_descarregar(&saida);             // Quarto de cada pedido, ou o motivo de não ter sido alocado
+    printf("%d reservas alocadas, %d pedidos sem quarto.\n", alocados, nao_alocados);
+}
+
+//MODO LOTE (COMANDOS NAO INTERATIVOS)
+// Uma operação por linha; campos separados por espaço; '#' inicia comentário:
+//   QUARTO <numero> <tipo> <preco> [status]     HOSPEDE <cpf> <nome> <telefone>
+//   RESERVAR <cpf> <quarto> <checkin> <checkout> CANCELAR <id>    CONCLUIR <id>
+//   DISPONIVEIS <checkin> <checkout>          SALVAR [arquivo]    CARREGAR [arquivo]
+//   ATIVAS (mesma listagem da opção 5 do menu)
+//   RELATORIO <inicio> <fim>  RELATORIO_MENSAL <ano>  (mesmos relatórios da opção 12 do menu)
+//   TARIFA <tipo|*> <inicio> <fim> <dias|*> <percentual>  (dias: dígitos 1 = domingo ... 7 = sábado)
+//   COTAR <checkin> <checkout> (quartos livres e valor da estadia, do mais barato ao mais caro)
+//   MEDIDAS [ZERAR] (contadores e histogramas da opção 14 do menu; ZERAR recomeça a contagem)
+//   MAIS_BARATOS <tipo> <checkin> <checkout> <k> (os k quartos livres mais baratos do tipo, com o valor da estadia)
+//   BUSCAR_NOME <k> <palavra> [palavra...] (CPFs de até k hóspedes com todas as palavras; última = prefixo; tolera erros)
+//   IMPORTAR <quartos|hospedes|reservas> <arquivo.csv>  EXPORTAR <quartos|hospedes|reservas> <csv|json> <arquivo>
+//   HOTEL <n> (comandos seguintes operam sobre o hotel n da rede, 1 a MAX_HOTEIS; um n novo cria o hotel)
+//   DISPONIVEIS_REDE <checkin> <checkout> (pares hotel:quarto livres em todos os hotéis)
+//   HISTORICO <cpf> (histórico do hóspede em toda a rede, como a opção 8 do menu)
+//   ALOCAR_GRUPO <arquivo.csv> (pedidos cpf,tipo,checkin,checkout; "ALOCADA <linha> <id> <quarto> <valor>" ou
+//                               "NAO_ALOCADA <linha> <motivo>" por pedido, antes do resumo; ver ALOCACAO DE GRUPOS)
+//   MANUTENCAO <quarto> <inicio> <fim>  FIM_MANUTENCAO <quarto> <inicio> <fim> (bloqueio das noites [inicio, fim))
+//   STATUS <quarto> [data] (LIVRE, OCUPADO ou MANUTENCAO na noite da data, derivado da agenda; padrão: hoje)
+// Cada comando gera uma linha "OK ..." ou "ERRO <linha> <motivo>" na saída.
+const char *descrever_erro(int codigo) {   // Texto de cada código de resultado do núcleo
+    switch (codigo) {
+        case OPERACAO_OK: return "ok";
+        case ERRO_QUARTO_EXISTENTE: return "quarto ja existe";
+        case ERRO_QUARTO_INEXISTENTE: return "quarto nao existe";
+        case ERRO_QUARTO_INDISPONIVEL: return "quarto ocupado ou em manutencao";
+        case ERRO_HOSPEDE_EXISTENTE: return "cpf ja cadastrado";
+        case ERRO_HOSPEDE_INEXISTENTE: return "hospede nao cadastrado";
+        case ERRO_DATAS_INVALIDAS: return "datas invalidas";
+        case ERRO_RESERVA_INVALIDA: return "reserva invalida ou inativa";
+        case ERRO_PARAMETRO_INVALIDO: return "parametro invalido";
+        case ERRO_ARQUIVO: return "falha de arquivo";
+        case ERRO_SNAPSHOT_INVALIDO: return "snapshot invalido";
+        case ERRO_REPETIR_EXCLUSIVO: return "operacao exige acesso exclusivo";
+        case ERRO_CPF_INVALIDO: return "cpf invalido";
+        case ERRO_TELEFONE_INVALIDO: return "telefone invalido";
+        default: return "erro desconhecido";
+    }
+}
+
+char *ler_linha(LeitorLinhas *leitor) {    // Próxima linha (sem '\n'), ou NULL no fim da entrada
+    // Linha maior que TAM_BUFFER_ENTRADA: é descartada até o próximo '\n' e volta vazia, com 'linha_longa' ligado
+    leitor->linha_longa = 0;
+    while (1) {
+        char *inicio = leitor->dados + leitor->inicio;
+        char *quebra = memchr(inicio, '\n', leitor->fim - leitor->inicio); // Procura o fim da linha no bloco
+        if (quebra != NULL) {
+            *quebra = '\0';
+            if (quebra > inicio && quebra[-1] == '\r') quebra[-1] = '\0'; // Aceita quebras de linha CRLF
+            leitor->inicio = (quebra - leitor->dados) + 1;
+            return leitor->linha_longa ? quebra : inicio; // Fim de linha longa: o pedaço final também é descartado
+        }
+        if (leitor->fim - leitor->inicio == TAM_BUFFER_ENTRADA) { // Bloco cheio sem '\n': linha longa demais
+            leitor->linha_longa = 1;
+            leitor->inicio = leitor->fim = 0; // Descarta o que já foi lido e segue até o fim da linha
+        } else if (leitor->fim_arquivo) {
+            if (leitor->inicio == leitor->fim && !leitor->linha_longa) return NULL; // Nada restou
+            leitor->dados[leitor->fim] = '\0'; // Última linha sem '\n'
+            leitor->inicio = leitor->fim;
+            return leitor->linha_longa ? leitor->dados + leitor->fim : inicio;
         }
+        memmove(leitor->dados, inicio, leitor->fim - leitor->inicio); // Move o pedaço incompleto para o começo
+        leitor->fim -= leitor->inicio;
+        leitor->inicio = 0;
+        size_t lidos;
+#ifdef PLATAFORMA_POSIX
+        if (leitor->descritor >= 0) {      // Socket: fread esperaria o bloco encher; read devolve o que já chegou
+            ssize_t recebidos;
+            do {
+                recebidos = read(leitor->descritor, leitor->dados + leitor->fim, TAM_BUFFER_ENTRADA - leitor->fim);
+            } while (recebidos < 0 && errno == EINTR);
+            lidos = (recebidos > 0) ? (size_t)recebidos : 0;
+        } else
+#endif
+        lidos = fread(leitor->dados + leitor->fim, 1, TAM_BUFFER_ENTRADA - leitor->fim, leitor->arquivo);
+        if (lidos == 0) leitor->fim_arquivo = 1;
+        leitor->fim += lidos;
     }
+}
 
-    return 1; // Disponível (nenhum conflito)
+int separar_campos(char *linha, char **campos) { // Divide a linha em campos (in-place); retorna a quantidade
+    int quantidade = 0;
+    char *c = linha;
+    while (1) {
+        while (*c == ' ' || *c == '\t') c++; // Pula separadores
+        if (*c == '\0' || *c == '#') break; // Fim da linha ou comentário
+        if (quantidade == MAX_CAMPOS_COMANDO) return -1; // Campos demais
+        campos[quantidade++] = c;
+        while (*c != '\0' && *c != ' ' && *c != '\t' && *c != '#') c++;
+        if (*c == '#') { *c = '\0'; break; }
+        if (*c != '\0') *c++ = '\0';
+    }
+    return quantidade;
 }
 
+int ler_inteiro(const char *texto, int *valor) { // Converte texto decimal em int; 0 se houver lixo
+    int negativo = (*texto == '-');
+    long acumulado = 0;
+    if (negativo) texto++;
+    if (*texto == '\0') return 0;
+    for (; *texto != '\0'; texto++) {
+        if (*texto < '0' || *texto > '9') return 0;
+        acumulado = acumulado * 10 + (*texto - '0');
+        if (acumulado > 2147483647L) return 0; // Estouro de int
+    }
+    *valor = (int)(negativo ? -acumulado : acumulado);
+    return 1;
+}
 
-void listar_quartos_disponiveis_periodo()
-{                                         // Lista quartos que estão livres para um período informado
-    if (contador_quartos == 0) {          // Se nenhum quarto cadastrado
-        printf("Nenhum quarto cadastrado.\n");
+int ler_preco(const char *texto, float *valor) { // Converte texto em float; 0 se houver lixo
+    char *fim;
+    *valor = strtof(texto, &fim);
+    return fim != texto && *fim == '\0';
+}
+
+int ler_dias_semana(const char *texto, int *mascara) { // "*" = todos; senão dígitos 1 (domingo) a 7 (sábado)
+    if (strcmp(texto, "*") == 0) {
+        *mascara = TODOS_OS_DIAS;
+        return 1;
+    }
+    *mascara = 0;
+    for (; *texto != '\0'; texto++) {
+        if (*texto < '1' || *texto > '7') return 0;
+        *mascara |= 1 << (*texto - '1');
+    }
+    return *mascara != 0;
+}
+
+int executar_comando_lote(char *linha, int numero_linha, BufferSaida *saida) { // 1 = ok, 0 = erro, -1 = linha vazia, -2 = repetir com acesso exclusivo
+    Hotel *hotel = hotel_atual;
+    char *campos[MAX_CAMPOS_COMANDO];      // Campos da linha (apontam para dentro de 'linha')
+    int n = separar_campos(linha, campos); // Quantidade de campos
+    int codigo = ERRO_PARAMETRO_INVALIDO;  // Resultado da operação (parâmetro inválido até prova em contrário)
+    int numero, id, status;                // Campos numéricos já convertidos
+    float valor;                           // Preço da diária
+    long long centavos;                    // Valor total da reserva
+    if (n == 0) return -1;                 // Linha em branco ou só comentário
+
+    if (n < 0) {
+        // Campos demais: mantém ERRO_PARAMETRO_INVALIDO
+    } else if (strcmp(campos[0], "QUARTO") == 0 && (n == 4 || n == 5)) {
+        status = LIVRE;                    // Status é opcional no comando
+        if (ler_inteiro(campos[1], &numero) && ler_preco(campos[3], &valor) &&
+            (n == 4 || ler_inteiro(campos[4], &status))) {
+            codigo = inserir_quarto(numero, campos[2], valor, status);
+            if (codigo == OPERACAO_OK) saida_printf(saida, "OK QUARTO %d\n", numero);
+        }
+    } else if (strcmp(campos[0], "HOSPEDE") == 0 && n == 4) {
+        codigo = inserir_hospede(campos[1], campos[2], campos[3], &id);
+        if (codigo == OPERACAO_OK) saida_printf(saida, "OK HOSPEDE %d\n", id);
+    } else if (strcmp(campos[0], "RESERVAR") == 0 && n == 5) {
+        int indice_hospede = buscar_hospede_por_cpf(campos[1]);
+        if (indice_hospede == -1) {
+            codigo = ERRO_HOSPEDE_INEXISTENTE;
+        } else if (ler_inteiro(campos[2], &numero)) {
+            codigo = criar_reserva(indice_hospede, numero, converter_data_em_dias(campos[3]),
+                                   converter_data_em_dias(campos[4]), &id, &centavos);
+            if (codigo == OPERACAO_OK) saida_printf(saida, "OK RESERVA %d %d %.2f\n", id, numero, centavos / 100.0);
+        }
+    } else if ((strcmp(campos[0], "CANCELAR") == 0 || strcmp(campos[0], "CONCLUIR") == 0) && n == 2) {
+        int cancelar = (campos[0][1] == 'A'); // CAncelar x COncluir
+        if (ler_inteiro(campos[1], &id)) {
+            codigo = alterar_status_reserva(id, cancelar ? CANCELADA : CONCLUIDA);
+            if (codigo == OPERACAO_OK) saida_printf(saida, "OK %s %d\n", cancelar ? "CANCELADA" : "CONCLUIDA", id);
+        }
+    } else if ((strcmp(campos[0], "MANUTENCAO") == 0 || strcmp(campos[0], "FIM_MANUTENCAO") == 0) && n == 4) {
+        int bloquear = (campos[0][0] == 'M');
+        if (ler_inteiro(campos[1], &numero)) {
+            long inicio = converter_data_em_dias(campos[2]);
+            long fim = converter_data_em_dias(campos[3]);
+            codigo = bloquear ? bloquear_manutencao(numero, inicio, fim) : liberar_manutencao(numero, inicio, fim);
+            if (codigo == OPERACAO_OK) saida_printf(saida, "OK %s %d\n", campos[0], numero);
+        }
+    } else if (strcmp(campos[0], "STATUS") == 0 && (n == 2 || n == 3)) {
+        static const char *nomes_status[] = {"LIVRE", "OCUPADO", "MANUTENCAO"};
+        if (ler_inteiro(campos[1], &numero)) {
+            codigo = consultar_status_quarto(numero, (n == 3) ? converter_data_em_dias(campos[2]) : dia_hoje(), &status);
+            if (codigo == OPERACAO_OK) saida_printf(saida, "OK STATUS %d %s\n", numero, nomes_status[status]);
+        }
+    } else if (strcmp(campos[0], "DISPONIVEIS") == 0 && n == 3) {
+        long dia_in = converter_data_em_dias(campos[1]);
+        long dia_out = converter_data_em_dias(campos[2]);
+        if (dia_in == DATA_INVALIDA || dia_out == DATA_INVALIDA || dia_out <= dia_in) {
+            codigo = ERRO_DATAS_INVALIDAS;
+        } else {
+            int *indices = (int *)malloc((hotel->contador_quartos + 1) * sizeof(int)); // +1: evita malloc(0)
+            if (indices == NULL) {         // Verifica falha de alocação
+                fprintf(stderr, "Erro fatal: Nao foi possivel alocar memoria para a consulta!\n");
+                exit(1);
+            }
+            int encontrados = coletar_quartos_disponiveis(dia_in, dia_out, indices);
+            if (encontrados < 0) {
+                codigo = ERRO_REPETIR_EXCLUSIVO;
+            } else {
+                saida_printf(saida, "OK DISPONIVEIS %d", encontrados);
+                for (int k = 0; k < encontrados; k++) { // Números dos quartos livres, em ordem de cadastro
+                    saida_printf(saida, " %d", hotel->quartos_hotel[indices[k]].numero);
+                }
+                saida_printf(saida, "\n");
+                codigo = OPERACAO_OK;
+            }
+            free(indices);
+        }
+    } else if (strcmp(campos[0], "DISPONIVEIS_REDE") == 0 && n == 3) {
+        long dia_in = converter_data_em_dias(campos[1]);
+        long dia_out = converter_data_em_dias(campos[2]);
+        if (dia_in == DATA_INVALIDA || dia_out == DATA_INVALIDA || dia_out <= dia_in) {
+            codigo = ERRO_DATAS_INVALIDAS;
+        } else {
+            int primeiros[MAX_HOTEIS], quantidades[MAX_HOTEIS];
+            int *indices = (int *)malloc((total_quartos_rede() + 1) * sizeof(int)); // +1: evita malloc(0)
+            if (indices == NULL) {         // Verifica falha de alocação
+                fprintf(stderr, "Erro fatal: Nao foi possivel alocar memoria para a consulta!\n");
+                exit(1);
+            }
+            int encontrados = coletar_disponiveis_rede(dia_in, dia_out, indices, primeiros, quantidades);
+            if (encontrados < 0) {
+                codigo = ERRO_REPETIR_EXCLUSIVO;
+            } else {
+                saida_printf(saida, "OK DISPONIVEIS_REDE %d", encontrados);
+                for (int h = 0; h < num_hoteis; h++) { // Hotel a hotel; dentro do hotel, em ordem de cadastro
+                    for (int k = 0; k < quantidades[h]; k++) {
+                        saida_printf(saida, " %d:%d", h + 1, hoteis[h].quartos_hotel[indices[primeiros[h] + k]].numero);
+                    }
+                }
+                saida_printf(saida, "\n");
+                codigo = OPERACAO_OK;
+            }
+            free(indices);
+        }
+    } else if (strcmp(campos[0], "HOTEL") == 0 && n == 2) {
+        if (ler_inteiro(campos[1], &numero)) {
+            codigo = selecionar_hotel(numero);
+            if (codigo == OPERACAO_OK) saida_printf(saida, "OK HOTEL %d\n", numero);
+        }
+    } else if (strcmp(campos[0], "HISTORICO") == 0 && n == 2) {
+        int indice_hospede = buscar_hospede_por_cpf(campos[1]);
+        if (indice_hospede == -1) {
+            codigo = ERRO_HOSPEDE_INEXISTENTE;
+        } else {
+            escrever_historico(saida, indice_hospede);
+            codigo = OPERACAO_OK;
+        }
+    } else if (strcmp(campos[0], "RELATORIO") == 0 && n == 3) {
+        long dia_in = converter_data_em_dias(campos[1]);
+        long dia_out = converter_data_em_dias(campos[2]);
+        if (dia_in == DATA_INVALIDA || dia_out == DATA_INVALIDA || dia_out <= dia_in) {
+            codigo = ERRO_DATAS_INVALIDAS;
+        } else {
+            escrever_relatorio_periodo(saida, dia_in, dia_out);
+            codigo = OPERACAO_OK;
+        }
+    } else if (strcmp(campos[0], "RELATORIO_MENSAL") == 0 && n == 2) {
+        if (ler_inteiro(campos[1], &numero) && numero >= 0 && numero <= 9999) {
+            escrever_relatorio_mensal(saida, numero);
+            codigo = OPERACAO_OK;
+        }
+    } else if (strcmp(campos[0], "TARIFA") == 0 && n == 6) {
+        if (ler_dias_semana(campos[4], &status) && ler_inteiro(campos[5], &numero)) {
+            codigo = inserir_regra_tarifa(campos[1], converter_data_em_dias(campos[2]), converter_data_em_dias(campos[3]),
+                                          status, numero);
+            if (codigo == OPERACAO_OK) saida_printf(saida, "OK TARIFA %d\n", hotel->contador_regras);
+        }
+    } else if (strcmp(campos[0], "COTAR") == 0 && n == 3) {
+        long dia_in = converter_data_em_dias(campos[1]);
+        long dia_out = converter_data_em_dias(campos[2]);
+        if (dia_in == DATA_INVALIDA || dia_out == DATA_INVALIDA || dia_out <= dia_in) {
+            codigo = ERRO_DATAS_INVALIDAS;
+        } else {
+            Oferta *ofertas = (Oferta *)malloc((hotel->contador_quartos + 1) * sizeof(Oferta)); // +1: evita malloc(0)
+            if (ofertas == NULL) {         // Verifica falha de alocação
+                fprintf(stderr, "Erro fatal: Nao foi possivel alocar memoria para a cotacao!\n");
+                exit(1);
+            }
+            int encontrados = cotar_estadia(dia_in, dia_out, ofertas);
+            if (encontrados < 0) {
+                codigo = ERRO_REPETIR_EXCLUSIVO;
+            } else {
+                saida_printf(saida, "OK COTACAO %d", encontrados);
+                for (int k = 0; k < encontrados; k++) { // Pares número do quarto / valor, do mais barato ao mais caro
+                    saida_printf(saida, " %d %lld.%02lld", hotel->quartos_hotel[ofertas[k].indice_quarto].numero,
+                                 ofertas[k].total_centavos / 100, ofertas[k].total_centavos % 100);
+                }
+                saida_printf(saida, "\n");
+                codigo = OPERACAO_OK;
+            }
+            free(ofertas);
+        }
+    } else if (strcmp(campos[0], "MAIS_BARATOS") == 0 && n == 5) {
+        long dia_in = converter_data_em_dias(campos[2]);
+        long dia_out = converter_data_em_dias(campos[3]);
+        if (dia_in == DATA_INVALIDA || dia_out == DATA_INVALIDA || dia_out <= dia_in) {
+            codigo = ERRO_DATAS_INVALIDAS;
+        } else if (ler_inteiro(campos[4], &numero) && numero > 0) {
+            if (numero > hotel->contador_quartos) numero = hotel->contador_quartos;
+            Oferta *ofertas = (Oferta *)malloc((numero + 1) * sizeof(Oferta)); // +1: evita malloc(0)
+            if (ofertas == NULL) {         // Verifica falha de alocação
+                fprintf(stderr, "Erro fatal: Nao foi possivel alocar memoria para a busca!\n");
+                exit(1);
+            }
+            int encontrados = buscar_mais_baratos(buscar_tipo_quarto(campos[1]), dia_in, dia_out, numero, ofertas);
+            if (encontrados < 0) {
+                codigo = ERRO_REPETIR_EXCLUSIVO;
+            } else {
+                saida_printf(saida, "OK MAIS_BARATOS %d", encontrados);
+                for (int k = 0; k < encontrados; k++) { // Pares número do quarto / valor, como no COTAR
+                    saida_printf(saida, " %d %lld.%02lld", hotel->quartos_hotel[ofertas[k].indice_quarto].numero,
+                                 ofertas[k].total_centavos / 100, ofertas[k].total_centavos % 100);
+                }
+                saida_printf(saida, "\n");
+                codigo = OPERACAO_OK;
+            }
+            free(ofertas);
+        }
+    } else if (strcmp(campos[0], "BUSCAR_NOME") == 0 && n >= 3) {
+        if (ler_inteiro(campos[1], &numero) && numero > 0 && numero <= MAX_RESULTADOS_NOME) {
+            char consulta[TAM_NOME] = "", cpf[TAM_CPF];
+            ResultadoNome resultados[MAX_RESULTADOS_NOME];
+            for (int c = 2; c < n; c++) {  // Palavras da consulta, separadas por um espaço
+                if (c > 2) strncat(consulta, " ", sizeof(consulta) - strlen(consulta) - 1);
+                strncat(consulta, campos[c], sizeof(consulta) - strlen(consulta) - 1);
+            }
+            int encontrados = buscar_hospedes_por_nome(consulta, numero, resultados);
+            if (encontrados < 0) {
+                codigo = ERRO_REPETIR_EXCLUSIVO;
+            } else {
+                saida_printf(saida, "OK NOMES %d", encontrados);
+                for (int r = 0; r < encontrados; r++) { // CPFs, do mais ao menos parecido
+                    saida_printf(saida, " %s", texto_cpf(hospedes_hotel[resultados[r].indice_hospede].cpf, cpf));
+                }
+                saida_printf(saida, "\n");
+                codigo = OPERACAO_OK;
+            }
+        }
+    } else if (strcmp(campos[0], "MEDIDAS") == 0 && (n == 1 || (n == 2 && strcmp(campos[1], "ZERAR") == 0))) {
+        escrever_medidas(saida);
+        if (n == 2) zerar_medidas();
+        codigo = OPERACAO_OK;
+    } else if (strcmp(campos[0], "IMPORTAR") == 0 && n == 3) {
+        int tabela = tabela_csv_por_nome(campos[1]);
+        if (tabela >= 0) {
+            codigo = importar_csv(tabela, campos[2], saida, &numero, &status); // Rejeições saem antes do resumo
+            if (codigo == OPERACAO_OK) saida_printf(saida, "OK IMPORTADOS %s %d %d\n", campos[1], numero, status);
+        }
+    } else if (strcmp(campos[0], "ALOCAR_GRUPO") == 0 && n == 2) {
+        codigo = alocar_grupo_arquivo(campos[1], saida, &numero, &status); // Um resultado por pedido antes do resumo
+        if (codigo == OPERACAO_OK) saida_printf(saida, "OK GRUPO %d %d\n", numero, status);
+    } else if (strcmp(campos[0], "EXPORTAR") == 0 && n == 4) {
+        int tabela = tabela_csv_por_nome(campos[1]);
+        int json = (strcmp(campos[2], "json") == 0);
+        if (tabela >= 0 && (json || strcmp(campos[2], "csv") == 0)) {
+            codigo = exportar_tabela(tabela, json, campos[3], &numero);
+            if (codigo == OPERACAO_OK) saida_printf(saida, "OK EXPORTADOS %s %d %s\n", campos[1], numero, campos[3]);
+        }
+    } else if (strcmp(campos[0], "ATIVAS") == 0 && n == 1) {
+        escrever_reservas_ativas(saida);
+        codigo = OPERACAO_OK;
+    } else if ((strcmp(campos[0], "SALVAR") == 0 || strcmp(campos[0], "CARREGAR") == 0) && n <= 2) {
+        const char *caminho = (n == 2) ? campos[1] : ARQUIVO_SNAPSHOT;
+        int salvar = (campos[0][0] == 'S');
+        if (salvar) {
+            codigo = salvar_snapshot(caminho);
+        } else if (arquivo_journal == NULL) { // Carga avulsa não é registrada no journal: só sem persistência
+            codigo = carregar_snapshot(caminho);
+        }
+        if (codigo == OPERACAO_OK) saida_printf(saida, "OK %s %s\n", salvar ? "SALVO" : "CARREGADO", caminho);
+    }
+    // Comando desconhecido ou com número errado de campos também cai aqui como parâmetro inválido
+
+    if (codigo == ERRO_REPETIR_EXCLUSIVO) {
+        return -2;                         // Nada foi alterado nem escrito: o servidor repete com a trava exclusiva
+    }
+    if (codigo != OPERACAO_OK) {
+        saida_printf(saida, "ERRO %d %s\n", numero_linha, descrever_erro(codigo));
+        return 0;
+    }
+    return 1;
+}
+
+int rejeitar_linha_longa(int numero_linha, BufferSaida *saida) { // Linha descartada por ler_linha: um único erro
+    saida_printf(saida, "ERRO %d %s\n", numero_linha, descrever_erro(ERRO_PARAMETRO_INVALIDO));
+    return 0;
+}
+
+void executar_lote(FILE *entrada, FILE *destino) { // Processa um fluxo de comandos até o fim
+    static LeitorLinhas leitor;            // Estáticos: buffers grandes demais para a pilha
+    static BufferSaida saida;
+    int numero_linha = 0, comandos = 0, erros = 0;
+    char *linha;
+
+    leitor.arquivo = entrada;
+    leitor.inicio = leitor.fim = 0;
+    leitor.fim_arquivo = 0;
+    leitor.descritor = -1;
+    saida.arquivo = destino;
+    saida.usado = 0;
+
+    while ((linha = ler_linha(&leitor)) != NULL) {
+        int resultado = leitor.linha_longa ? rejeitar_linha_longa(++numero_linha, &saida)
+                                           : executar_comando_lote(linha, ++numero_linha, &saida);
+        if (resultado >= 0) comandos++;
+        if (resultado == 0) erros++;
+    }
+    saida_descarregar(&saida);
+    fprintf(stderr, "Lote concluido: %d comandos, %d erros.\n", comandos, erros); // Resumo fora do fluxo de resultados
+}
+
+//MODO SERVIDOR (SOCKET LOCAL, CLIENTES CONCORRENTES)
+// hotel --servidor [caminho]: aceita conexões no socket Unix 'caminho' (padrão hotel.sock). Cada cliente
+// envia comandos do modo lote, um por linha, e recebe as mesmas respostas; cada conexão tem sua thread.
+// Respostas só saem depois do fsync do journal, feito em grupo para todos os clientes. SIGINT/SIGTERM
+// encerram o servidor gravando o snapshot.
+#ifdef PLATAFORMA_POSIX
+volatile sig_atomic_t servidor_encerrando = 0; // Ligado pelo tratador de sinal
+
+void servidor_sinal(int sinal) {          // SIGINT/SIGTERM: interrompe o accept e encerra
+    (void)sinal;
+    servidor_encerrando = 1;
+}
+
+int comando_exige_exclusivo(const char *linha) { // Comandos que mudam a estrutura das tabelas ou leem todas elas
+    char nome[16] = "";
+    sscanf(linha, "%15s", nome);
+    return strcmp(nome, "QUARTO") == 0 || strcmp(nome, "HOSPEDE") == 0 || strcmp(nome, "TARIFA") == 0 ||
+           strcmp(nome, "MEDIDAS") == 0 || strcmp(nome, "HISTORICO") == 0 ||
+           strcmp(nome, "IMPORTAR") == 0 || strcmp(nome, "ALOCAR_GRUPO") == 0 ||
+           strcmp(nome, "SALVAR") == 0 || strcmp(nome, "CARREGAR") == 0;
+}
+
+int executar_comando_servidor(const char *linha, char *copia, int numero_linha, BufferSaida *saida) { // Um comando sob trava_estrutura
+    int exclusivo = comando_exige_exclusivo(linha);
+    while (1) {
+        if (exclusivo) {
+            pthread_rwlock_wrlock(&trava_estrutura);
+            acesso_exclusivo = 1;          // Sozinho nas tabelas: dispensa as travas finas
+        } else {
+            pthread_rwlock_rdlock(&trava_estrutura);
+        }
+        strcpy(copia, linha);              // executar_comando_lote altera a linha; a repetição precisa do original
+        int resultado = executar_comando_lote(copia, numero_linha, saida);
+        if (exclusivo) acesso_exclusivo = 0;
+        pthread_rwlock_unlock(&trava_estrutura);
+        if (resultado != -2) {
+            return resultado;
+        }
+        exclusivo = 1;                     // Tabela cheia ou calendário a refazer: repete com a trava exclusiva
+    }
+}
+
+void *atender_cliente(void *argumento) {  // Thread de uma conexão: lê comandos e responde até o cliente fechar
+    int descritor = (int)(long)argumento;
+    LeitorLinhas *leitor = (LeitorLinhas *)malloc(sizeof(LeitorLinhas)); // Grandes demais para a pilha da thread
+    BufferSaida *saida = (BufferSaida *)malloc(sizeof(BufferSaida));
+    char *copia = (char *)malloc(TAM_BUFFER_ENTRADA + 1);
+    FILE *destino = fdopen(dup(descritor), "w");
+    if (leitor == NULL || saida == NULL || copia == NULL || destino == NULL) {
+        fprintf(stderr, "Erro fatal: Nao foi possivel alocar memoria para o cliente!\n");
+        exit(1);
+    }
+    leitor->arquivo = NULL;
+    leitor->inicio = leitor->fim = 0;
+    leitor->fim_arquivo = 0;
+    leitor->descritor = descritor;
+    saida->arquivo = destino;
+    saida->usado = 0;
+
+    char *linha;
+    int numero_linha = 0;
+    while ((linha = ler_linha(leitor)) != NULL) {
+        if (leitor->linha_longa) rejeitar_linha_longa(++numero_linha, saida);
+        else executar_comando_servidor(linha, copia, ++numero_linha, saida);
+        if (leitor->inicio == leitor->fim) { // Sem mais comandos já recebidos: responde o que acumulou
+            saida_descarregar(saida);
+        }
+    }
+    saida_descarregar(saida);
+    fclose(destino);
+    close(descritor);
+    free(leitor);
+    free(saida);
+    free(copia);
+    return NULL;
+}
+
+int executar_servidor(const char *caminho) { // Laço de aceitação; retorna ao receber SIGINT/SIGTERM
+    struct sockaddr_un endereco;
+    memset(&endereco, 0, sizeof(endereco));
+    endereco.sun_family = AF_UNIX;
+    if (strlen(caminho) >= sizeof(endereco.sun_path)) {
+        fprintf(stderr, "Caminho do socket longo demais: %s\n", caminho);
+        return 1;
+    }
+    strcpy(endereco.sun_path, caminho);
+    int escuta = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(caminho);                       // Socket de uma execução anterior
+    if (escuta < 0 || bind(escuta, (struct sockaddr *)&endereco, sizeof(endereco)) != 0 || listen(escuta, 64) != 0) {
+        fprintf(stderr, "Nao foi possivel escutar em %s\n", caminho);
+        return 1;
+    }
+
+    struct sigaction acao;
+    memset(&acao, 0, sizeof(acao));
+    acao.sa_handler = servidor_sinal;      // Sem SA_RESTART: o accept volta com EINTR
+    sigaction(SIGINT, &acao, NULL);
+    sigaction(SIGTERM, &acao, NULL);
+    signal(SIGPIPE, SIG_IGN);              // Cliente que fecha antes da resposta não derruba o servidor
+
+    pthread_attr_t atributos;
+    pthread_attr_init(&atributos);
+    pthread_attr_setdetachstate(&atributos, PTHREAD_CREATE_DETACHED);
+    acesso_exclusivo = 0;                  // A partir daqui as tabelas são compartilhadas
+    printf("Servidor escutando em %s\n", caminho);
+    fflush(stdout);
+    while (!servidor_encerrando) {
+        int cliente = accept(escuta, NULL, NULL);
+        if (cliente < 0) {
+            if (errno != EINTR) perror("accept");
+            continue;
+        }
+        pthread_t thread;
+        if (pthread_create(&thread, &atributos, atender_cliente, (void *)(long)cliente) != 0) {
+            close(cliente);                // Sem recursos para outra thread: recusa a conexão
+        }
+    }
+    pthread_attr_destroy(&atributos);
+    close(escuta);
+    unlink(caminho);
+
+    pthread_rwlock_wrlock(&trava_estrutura); // Espera os comandos em andamento; clientes restantes não voltam a entrar
+    acesso_exclusivo = 1;
+    printf("\nEncerrando servidor\n");
+    return 0;
+}
+#endif
+
+//BENCHMARK (CARGA SINTETICA)
+// hotel --bench [quartos] [hospedes] [reservas] [percentual_cancelamento] [semente]
+// Gera um hotel sintético pelas mesmas funções do núcleo e mede cada operação: vazão, p50 e p99.
+unsigned long long estado_aleatorio = 88172645463325252ULL; // Estado do gerador xorshift64*
+
+unsigned long long aleatorio() {           // Gerador xorshift64*: rápido e reproduzível pela semente
+    estado_aleatorio ^= estado_aleatorio >> 12;
+    estado_aleatorio ^= estado_aleatorio << 25;
+    estado_aleatorio ^= estado_aleatorio >> 27;
+    return estado_aleatorio * 2685821657736338717ULL;
+}
+
+int aleatorio_faixa(int limite) {          // Inteiro uniforme em [0, limite)
+    return (int)(aleatorio() % (unsigned long long)limite);
+}
+
+double agora_ns() {                        // Relógio monotônico em nanossegundos
+    return (double)relogio_ns();
+}
+
+int comparar_double(const void *a, const void *b) { // Ordena latências (qsort)
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+void bench_relatorio(const char *nome, double *latencias, int quantidade) { // Imprime vazão, p50 e p99 de uma operação
+    if (quantidade == 0) {
+        printf("%-28s | %9d | %12s | %10s | %10s\n", nome, 0, "-", "-", "-");
         return;
     }
+    double total = 0;
+    for (int i = 0; i < quantidade; i++) total += latencias[i];
+    qsort(latencias, quantidade, sizeof(double), comparar_double);
+    printf("%-28s | %9d | %12.0f | %10.0f | %10.0f\n", nome, quantidade,
+           quantidade / (total / 1e9),                        // Operações por segundo
+           latencias[(int)(quantidade * 0.50)],               // Mediana
+           latencias[(int)(quantidade * 0.99)]);              // Percentil 99
+}
 
-    char data_in[TAM_DATA];                // Buffer para data de check-in
-    char data_out[TAM_DATA];               // Buffer para data de check-out
+long bench_duracao_estadia() {             // Noites de estadia: maioria curta, cauda até 14 (distribuição geométrica)
+    long noites = 1;
+    while (noites < 14 && aleatorio_faixa(100) < 55) noites++;
+    return noites;
+}
 
-    printf("Digite a data de Check-in (DD/MM/AAAA): ");
-    scanf("%s", data_in);                  // Lê check-in
+void executar_benchmark(int num_quartos, int num_hospedes, int num_reservas, int percentual_cancelamento) {
+    Hotel *hotel = hotel_atual;
+    static const char *tipos[] = {"Standard", "Deluxe", "Suite"};
+    static const char *prenomes[] = {"Ana", "Bruno", "Camila", "Daniel", "Eduarda", "Felipe", "Gabriela", "Henrique",
+                                     "Isabela", "Joao", "Larissa", "Lucas", "Mariana", "Matheus", "Natalia", "Otavio",
+                                     "Paula", "Rafael", "Sofia", "Thiago", "Vitoria", "Gustavo", "Beatriz", "Pedro"};
+    static const char *sobrenomes[] = {"Silva", "Santos", "Oliveira", "Souza", "Rodrigues", "Ferreira", "Alves",
+                                       "Pereira", "Lima", "Gomes", "Costa", "Ribeiro", "Martins", "Carvalho",
+                                       "Almeida", "Lopes", "Soares", "Fernandes", "Vieira", "Barbosa", "Rocha",
+                                       "Dias", "Nascimento", "Andrade", "Moreira", "Nunes", "Marques", "Machado",
+                                       "Mendes", "Freitas", "Cardoso", "Ramos"};
+    static BufferSaida descarte;           // Saída descartada: mede a montagem do histórico sem o terminal
+    long base = dia_hoje();                // Reservas espalhadas pelo próximo ano
+    int max_medidas = 100000;              // Uma latência por chamada da fase mais longa
+    if (num_quartos > max_medidas) max_medidas = num_quartos;
+    if (num_hospedes > max_medidas) max_medidas = num_hospedes;
+    if (num_reservas > max_medidas) max_medidas = num_reservas;
+    double *latencias = (double *)malloc(max_medidas * sizeof(double));
+    int *indices = (int *)malloc((num_quartos + 1) * sizeof(int));
+    int *ids_ativos = (int *)malloc((num_quartos + 1) * sizeof(int)); // Reserva ativa de cada quarto (0 = nenhuma)
+    Oferta *ofertas = (Oferta *)malloc((num_quartos + 1) * sizeof(Oferta));
+    char cpf[TAM_CPF], nome[TAM_NOME], telefone[TAM_TELEFONE];
+    double t0, t1;
+    int n;
 
-    printf("Digite a data de Check-out (DD/MM/AAAA): ");
-    scanf("%s", data_out);                 // Lê check-out
+    if (latencias == NULL || indices == NULL || ids_ativos == NULL || ofertas == NULL) {
+        printf("Erro fatal: Nao foi possivel alocar memoria para o benchmark!\n");
+        exit(1);
+    }
+    descarte.arquivo = NULL;
+    printf("Benchmark: %d quartos, %d hospedes, %d reservas, %d%% canceladas, %d threads\n\n",
+           num_quartos, num_hospedes, num_reservas, percentual_cancelamento, threads_disponiveis());
+    printf("%-28s | %9s | %12s | %10s | %10s\n", "Operacao", "Chamadas", "Ops/s", "p50 (ns)", "p99 (ns)");
+    printf("-----------------------------------------------------------------------------------\n");
 
-    printf("\n--- QUARTOS DISPONIVEIS DE %s A %s ---\n", data_in, data_out); // Cabeçalho mostrando período
+    for (n = 0; n < num_quartos; n++) {    // Quartos: numeração por andar (101, 102, ...)
+        t0 = agora_ns();
+        inserir_quarto(100 * (1 + n / 100) + n % 100 + 1, tipos[n % 3], 150.0f + 100.0f * (n % 3), LIVRE);
+        latencias[n] = agora_ns() - t0;
+        ids_ativos[n] = 0;
+    }
+    bench_relatorio("cadastrar quarto", latencias, n);
+
+    for (n = 0; n < num_hospedes; n++) {
+        snprintf(cpf, sizeof(cpf), "%011d", 10000000 + n * 7919 % 90000000); // CPFs distintos, fora de ordem
+        snprintf(nome, sizeof(nome), "%s %s %s", prenomes[aleatorio_faixa(24)], // Nomes com distribuição realista
+                 sobrenomes[aleatorio_faixa(32)], sobrenomes[aleatorio_faixa(32)]);
+        snprintf(telefone, sizeof(telefone), "119%08d", n);
+        t0 = agora_ns();
+        inserir_hospede(cpf, nome, telefone, NULL);
+        latencias[n] = agora_ns() - t0;
+    }
+    bench_relatorio("cadastrar hospede", latencias, n);
 
-    int encontrou = 0;                     // Flag para indicar se encontrou algum quarto
+    // Reservas: cada uma vai para um quarto sorteado; a anterior do quarto é concluída ou cancelada antes
+    int criadas = 0, alteradas = 0;
+    double *latencias_status = (double *)malloc(num_reservas * sizeof(double) + 1);
+    if (latencias_status == NULL) {
+        printf("Erro fatal: Nao foi possivel alocar memoria para o benchmark!\n");
+        exit(1);
+    }
+    for (int i = 0; i < num_reservas && num_quartos > 0 && num_hospedes > 0; i++) {
+        int q = aleatorio_faixa(num_quartos);
+        if (ids_ativos[q] != 0) {          // Libera o quarto: cancela ou conclui a reserva anterior
+            int status = (aleatorio_faixa(100) < percentual_cancelamento) ? CANCELADA : CONCLUIDA;
+            t0 = agora_ns();
+            alterar_status_reserva(ids_ativos[q], status);
+            latencias_status[alteradas++] = agora_ns() - t0;
+            ids_ativos[q] = 0;
+        }
+        long checkin = base + aleatorio_faixa(365);
+        long checkout = checkin + bench_duracao_estadia();
+        int id;
+        t0 = agora_ns();
+        int codigo = criar_reserva(aleatorio_faixa(num_hospedes), hotel->quartos_hotel[q].numero, checkin, checkout, &id, NULL);
+        t1 = agora_ns();
+        if (codigo == OPERACAO_OK) {
+            latencias[criadas++] = t1 - t0;
+            ids_ativos[q] = id;
+        }
+    }
+    bench_relatorio("realizar reserva", latencias, criadas);
+    bench_relatorio("gerenciar reserva", latencias_status, alteradas);
+    free(latencias_status);
+
+    int consultas = 100000;
+    for (n = 0; n < consultas && num_quartos > 0; n++) { // Buscas por número de quarto
+        int numero = hotel->quartos_hotel[aleatorio_faixa(num_quartos)].numero;
+        t0 = agora_ns();
+        buscar_quarto_por_numero(numero);
+        latencias[n] = agora_ns() - t0;
+    }
+    bench_relatorio("buscar quarto por numero", latencias, n);
+
+    for (n = 0; n < consultas && num_hospedes > 0; n++) { // Buscas por CPF digitado (validação + hash + comparação)
+        texto_cpf(hospedes_hotel[aleatorio_faixa(num_hospedes)].cpf, cpf);
+        t0 = agora_ns();
+        buscar_hospede_por_cpf(cpf);
+        latencias[n] = agora_ns() - t0;
+    }
+    bench_relatorio("buscar hospede por cpf", latencias, n);
 
-    for (int i = 0; i < contador_quartos; i++) { // Percorre todos os quartos
-        if (quarto_disponivel_periodo(quartos_hotel[i].numero, data_in, data_out)) { // Se disponível no período
-            printf("Quarto %d (%s) - R$ %.2f / dia\n",
-                   quartos_hotel[i].numero,  // Número do quarto
-                   quartos_hotel[i].tipo,    // Tipo do quarto
-                   quartos_hotel[i].preco_diaria); // Preço por dia
+    for (n = 0; n < consultas && num_quartos > 0; n++) { // Disponibilidade de um quarto
+        long checkin = base + aleatorio_faixa(365);
+        long checkout = checkin + bench_duracao_estadia();
+        int q = aleatorio_faixa(num_quartos);
+        t0 = agora_ns();
+        quarto_disponivel_indice(q, checkin, checkout);
+        latencias[n] = agora_ns() - t0;
+    }
+    bench_relatorio("quarto disponivel periodo", latencias, n);
+
+    int listagens = 2000;
+    for (n = 0; n < listagens; n++) {      // Lista completa de quartos livres
+        long checkin = base + aleatorio_faixa(365);
+        long checkout = checkin + bench_duracao_estadia();
+        t0 = agora_ns();
+        coletar_quartos_disponiveis(checkin, checkout, indices);
+        latencias[n] = agora_ns() - t0;
+    }
+    bench_relatorio("listar quartos disponiveis", latencias, n);
+
+    for (n = 0; n < consultas && num_hospedes > 0; n++) { // Histórico (busca por CPF + montagem do texto)
+        texto_cpf(hospedes_hotel[aleatorio_faixa(num_hospedes)].cpf, cpf);
+        t0 = agora_ns();
+        escrever_historico(&descarte, buscar_hospede_por_cpf(cpf));
+        latencias[n] = agora_ns() - t0;
+        descarte.usado = 0;
+    }
+    bench_relatorio("mostrar historico", latencias, n);
 
-            encontrou = 1;               // Marca que encontrou pelo menos um
+    ResultadoNome resultados_nome[MAX_RESULTADOS_NOME];
+    for (n = 0; n < consultas && num_hospedes > 0; n++) { // Nome: metade por prefixo, metade com uma letra a menos
+        char consulta[TAM_NOME];
+        snprintf(consulta, sizeof(consulta), "%s", nome_hospede(&hospedes_hotel[aleatorio_faixa(num_hospedes)]));
+        char *espaco = strrchr(consulta, ' ');
+        if (n % 2 == 0 && espaco != NULL) {
+            espaco[espaco[1] != '\0' ? 2 : 0] = '\0'; // "Ana Silva C": último sobrenome só pela inicial
+        } else {
+            int p = 1 + aleatorio_faixa((int)strlen(consulta) - 1);
+            if (consulta[p] != ' ') memmove(consulta + p, consulta + p + 1, strlen(consulta + p));
         }
+        t0 = agora_ns();
+        buscar_hospedes_por_nome(consulta, 10, resultados_nome);
+        latencias[n] = agora_ns() - t0;
     }
+    bench_relatorio("buscar hospede por nome", latencias, n);
 
-    if (!encontrou) {                      // Se não encontrou nenhum quarto disponível
-        printf("Nenhum quarto disponível para esse período.\n");
+    for (n = 0; n < 200; n++) {            // Listagem completa das reservas ativas
+        t0 = agora_ns();
+        escrever_reservas_ativas(&descarte);
+        latencias[n] = agora_ns() - t0;
+        descarte.usado = 0;
+    }
+    bench_relatorio("listar reservas ativas", latencias, n);
+
+    for (n = 0; n < 2000; n++) {           // Relatório de 30 noites (agregados por tipo)
+        long inicio = base + aleatorio_faixa(335);
+        t0 = agora_ns();
+        escrever_relatorio_periodo(&descarte, inicio, inicio + 30);
+        latencias[n] = agora_ns() - t0;
+        descarte.usado = 0;
     }
+    bench_relatorio("relatorio de ocupacao", latencias, n);
+
+    inserir_regra_tarifa("*", base, base + 400, (1 << 5) | (1 << 6), 125); // Fim de semana +25%
+    inserir_regra_tarifa("Suite", base + 150, base + 240, TODOS_OS_DIAS, 140); // Alta temporada das suítes
+    for (n = 0; n < listagens; n++) {      // Cotação de todos os quartos livres, com regras de tarifa
+        long checkin = base + aleatorio_faixa(365);
+        long checkout = checkin + bench_duracao_estadia();
+        t0 = agora_ns();
+        cotar_estadia(checkin, checkout, ofertas);
+        latencias[n] = agora_ns() - t0;
+    }
+    bench_relatorio("cotar estadia", latencias, n);
+
+    for (n = 0; n < consultas; n++) {      // Os 5 quartos livres mais baratos de um tipo (índice por preço)
+        long checkin = base + aleatorio_faixa(365);
+        long checkout = checkin + bench_duracao_estadia();
+        int id_tipo = aleatorio_faixa(hotel->contador_tipos > 0 ? hotel->contador_tipos : 1);
+        t0 = agora_ns();
+        buscar_mais_baratos(id_tipo, checkin, checkout, 5, ofertas);
+        latencias[n] = agora_ns() - t0;
+    }
+    bench_relatorio("mais baratos por tipo (k=5)", latencias, n);
+
+    free(latencias);
+    free(indices);
+    free(ids_ativos);
+    free(ofertas);
+}
+
+void liberar_hotel() {                     // Libera as estruturas de hotel_atual
+    Hotel *hotel = hotel_atual;
+    if (hotel->quartos_hotel != NULL) {    // Libera memória alocada para quartos
+        free(hotel->quartos_hotel);
+    }
+    if (hotel->agendas_quartos != NULL) {  // Libera a agenda de cada quarto e o array de agendas
+        for (int i = 0; i < hotel->capacidade_quartos; i++) { // Agendas além de contador_quartos estão zeradas
+            free(hotel->agendas_quartos[i].intervalos);
+        }
+        free(hotel->agendas_quartos);
+    }
+    tabela_reservas_liberar(&hotel->reservas_hotel); // Libera as colunas das reservas ativas e do arquivo
+    tabela_reservas_liberar(&hotel->reservas_arquivadas);
+    free(hotel->travas_quartos);           // Libera as travas e os tipos dos quartos
+    free(hotel->tipos_dos_quartos);
+    analise_liberar();                     // Libera o dicionário de tipos e as séries de análise
+    free(hotel->regras_tarifa);            // Libera as regras de tarifa
+    indice_preco_liberar();                // Libera o índice por tipo e preço
+    if (hotel->vista_reservas != NULL) {   // Libera a última vista (sem leitores ao encerrar)
+        tabela_reservas_liberar(&hotel->vista_reservas->ativas);
+        free(hotel->vista_reservas);
+    }
+    free(hotel->indice_reservas_id);       // Libera o índice de reservas por ID e os de quartos
+    free(hotel->indice_quartos_direto);
+    free(hotel->indice_quartos_hash);
+    free(hotel->calendario_ocupacao);      // Libera os bitmaps do calendário e as áreas de trabalho das consultas
+    free(hotel->calendario_acumulado);
+    free(hotel->marcas_livres);
+}
+
+void liberar_tabelas() {                   // Libera hotéis e hóspedes e volta ao estado inicial (rede vazia)
+    for (int h = 0; h < MAX_HOTEIS; h++) { // Cada hotel da rede (os não usados estão zerados)
+        hotel_atual = &hoteis[h];
+        liberar_hotel();
+        memset(&hoteis[h], 0, sizeof(Hotel)); // Zerado = vazio
+    }
+    hotel_atual = &hoteis[0];
+    num_hoteis = 1;
+    free(hospedes_hotel);                  // Libera o array de hóspedes, a arena de nomes e o pool de históricos
+    free(arena_nomes);
+    free(pool_historicos);
+    indice_nomes_liberar();                // Libera o índice de nomes
+    free(indice_cpf);                      // Libera a tabela hash de CPF (free(NULL) é seguro)
+    free(indice_hospedes_id);              // Libera o índice de hóspedes por ID
+    hospedes_hotel = NULL;
+    arena_nomes = NULL;
+    pool_historicos = indice_cpf = indice_hospedes_id = NULL;
+    contador_hospedes = capacidade_hospedes = 0;
+    tamanho_arena_nomes = capacidade_arena_nomes = 0;
+    tamanho_pool_historicos = capacidade_pool_historicos = 0;
+    capacidade_indice_cpf = capacidade_indice_hospedes_id = 0;
+}
+
+void liberar_memoria() {                   // Libera todas as estruturas globais antes de encerrar
+    pool_encerrar();                       // Encerra as threads das consultas paralelas
+    liberar_tabelas();
 }
 
-int main(){                                // Função principal do programa
+
+int main(int argc, char *argv[]){          // Função principal do programa
     int opcao = 0;                         // Variável para opção do menu
 
+    if (argc >= 2 && strcmp(argv[1], "--lote") == 0) { // Modo lote: hotel --lote [arquivo] [--persistente]
+        FILE *entrada = stdin;             // Sem arquivo, lê stdin
+        int persistente = 0;               // --persistente: parte do snapshot/journal e registra as alterações
+        for (int i = 2; i < argc; i++) {
+            if (strcmp(argv[i], "--persistente") == 0) {
+                persistente = 1;
+            } else if ((entrada = fopen(argv[i], "r")) == NULL) {
+                fprintf(stderr, "Nao foi possivel abrir %s\n", argv[i]);
+                return 1;
+            }
+        }
+        if (persistente) {
+            iniciar_persistencia();        // Diagnósticos da carga vão para stderr, fora do fluxo de resultados
+        }
+        executar_lote(entrada, stdout);
+        if (entrada != stdin) fclose(entrada);
+        encerrar_persistencia();
+        liberar_memoria();
+        return 0;
+    }
+
+    if (argc >= 2 && strcmp(argv[1], "--bench") == 0) { // Benchmark: hotel --bench [quartos] [hospedes] [reservas] [%cancel] [semente]
+        int parametros[5] = {500, 5000, 50000, 10, 1}; // Valores padrão
+        for (int i = 2; i < argc && i < 7; i++) {
+            if (!ler_inteiro(argv[i], &parametros[i - 2]) || parametros[i - 2] < 0) {
+                fprintf(stderr, "Parametro invalido: %s\n", argv[i]);
+                return 1;
+            }
+        }
+        estado_aleatorio ^= (unsigned long long)parametros[4] * 0x9E3779B97F4A7C15ULL; // Semente
+        if (estado_aleatorio == 0) estado_aleatorio = 1;
+        executar_benchmark(parametros[0], parametros[1], parametros[2], parametros[3]);
+        liberar_memoria();
+        return 0;
+    }
+
+#ifdef PLATAFORMA_POSIX
+    if (argc >= 2 && strcmp(argv[1], "--servidor") == 0) { // Servidor: hotel --servidor [caminho do socket]
+        iniciar_persistencia();
+        if (executar_servidor(argc >= 3 ? argv[2] : ARQUIVO_SOCKET) != 0) {
+            encerrar_persistencia();
+            return 1;
+        }
+        salvar_snapshot_menu();            // Mesmo encerramento do menu: snapshot + journal vazio
+        encerrar_persistencia();
+        liberar_memoria();
+        return 0;
+    }
+#endif
+
+    iniciar_persistencia();                // Snapshot + journal da execução anterior
+
     do{
         printf("\n--- MENU PRINCIPAL ---\n"); // Mostra menu
         printf("1 - CADASTRAR QUARTO\n");
@@ -593,6 +5907,18 @@ int main(){                                // Função principal do programa
         printf("8 - HISTORICO DE RESERVAS\n");
         printf("9 - VERIFICAR DISPONIBILIDADE POR PERIODO\n");
         printf("10 - SAIR\n");
+        printf("11 - SALVAR SNAPSHOT\n");
+        printf("12 - RELATORIO DE OCUPACAO E RECEITA\n");
+        printf("13 - COTAR ESTADIA\n");
+        printf("14 - MEDIDAS DE DESEMPENHO\n");
+        printf("15 - IMPORTAR/EXPORTAR DADOS\n");
+        printf("16 - QUARTOS MAIS BARATOS POR TIPO\n");
+        printf("17 - BUSCAR HOSPEDE POR NOME\n");
+        printf("18 - SELECIONAR HOTEL DA REDE\n");
+        printf("19 - DISPONIBILIDADE NA REDE POR PERIODO\n");
+        printf("20 - ALOCAR GRUPO DE RESERVAS (CSV)\n");
+        printf("21 - MANUTENCAO DE QUARTO POR PERIODO\n");
+        printf("22 - STATUS DOS QUARTOS EM UMA DATA\n");
         printf("Escolha uma opcao: ");
         scanf("%d", &opcao);               // Lê opção escolhida pelo usuário
 
@@ -621,27 +5947,53 @@ int main(){                                // Função principal do programa
             case 8: 
                 mostrar_historico();       // Mostra histórico de um hóspede
                 break;
+            case 11:
+                salvar_snapshot_menu();    // Grava o estado atual em disco
+                break;
+            case 12:
+                relatorio_ocupacao();      // Ocupação, receita, ADR e RevPAR por tipo de quarto
+                break;
+            case 13:
+                cotar_estadia_menu();      // Todos os quartos livres com o valor da estadia
+                break;
+            case 14:
+                mostrar_medidas();         // Contadores e histogramas de latência das operações
+                break;
+            case 15:
+                importar_exportar_menu();  // Carga de CSV e exportação em CSV/JSON
+                break;
+            case 16:
+                mais_baratos_menu();       // Os k quartos livres mais baratos de um tipo
+                break;
+            case 17:
+                buscar_hospede_nome_menu(); // Hóspedes pelo nome, com tolerância a erros de digitação
+                break;
+            case 18:
+                selecionar_hotel_menu();   // Hotel sobre o qual as demais opções operam
+                break;
+            case 19:
+                listar_disponiveis_rede_menu(); // Quartos livres em todos os hotéis
+                break;
+            case 20:
+                alocar_grupo_menu();       // Quarto de cada pedido escolhido pela agenda
+                break;
+            case 21:
+                manutencao_quarto_menu();  // Bloqueio de manutenção em um período
+                break;
+            case 22:
+                status_quartos_menu();     // Status de cada quarto na data, pela agenda
+                break;
             case 9:
                 listar_quartos_disponiveis_periodo(); // Verifica disponibilidade por período
             default:
                 printf("Saindo do programa\n"); // Mensagem padrão (observação: comportamento atual sai mesmo para opções inválidas)
         }
+        journal_confirmar();               // Confirma (fsync) as alterações feitas pela opção
     }while (opcao != 10);                  // Repete enquanto opção for diferente de 10 (SAIR)
 
-    if (quartos_hotel != NULL) {           // Antes de encerrar, libera memória alocada para quartos
-        free(quartos_hotel);
-    }
-    if(reservas_hotel != NULL){            // Libera memória das reservas, se alocada
-        free(reservas_hotel);
-    }
-     if (hospedes_hotel != NULL) {         // Se houver hóspedes alocados
-        for(int i = 0; i < contador_hospedes; i++) { // Para cada hóspede, libera o histórico de IDs se existir
-            if(hospedes_hotel[i].historico_ids_reservas != NULL) {
-                free(hospedes_hotel[i].historico_ids_reservas);
-            }
-        }
-        free(hospedes_hotel);              // Libera o array de hóspedes
-    }
+    salvar_snapshot_menu();                // Grava o estado para a próxima execução (e esvazia o journal)
+    encerrar_persistencia();
+    liberar_memoria();                     // Antes de encerrar, libera toda a memória alocada
 
     return 0;                              // Encerra o programa com sucesso
 }